@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <err.h>
+#include <SDL2/SDL.h>
+#include "preprocess.h"
+#include "extract_grid.h"
+#include "bitmap.h"
+
+// Compares the binarization methods on puzzle images:
+//  - time per image and per megapixel
+//  - share of ink pixels
+//  - whether extract_grid still finds a grid in the result, its size and the
+//    time it takes
+// Usage: bench_binarize [image.bmp | directory ...] [-r repeats]   (default: data/)
+
+#define MAX_IMAGES 256
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int add_path(char paths[][512], int n, const char* path)
+{
+    DIR* dir = opendir(path);
+    if (!dir) {
+        if (n < MAX_IMAGES) snprintf(paths[n++], 512, "%s", path);
+        return n;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL && n < MAX_IMAGES) {
+        size_t len = strlen(entry->d_name);
+        if (len < 4 || strcasecmp(entry->d_name + len - 4, ".bmp") != 0) continue;
+        snprintf(paths[n++], 512, "%s/%s", path, entry->d_name);
+    }
+    closedir(dir);
+    return n;
+}
+
+static int cmp_paths(const void* a, const void* b)
+{
+    return strcmp((const char*)a, (const char*)b);
+}
+
+static double ink_ratio(SDL_Surface* bw)
+{
+    long ink = 0;
+    for (int y = 0; y < bw->h; y++) {
+        const Uint32* row = (const Uint32*)((const Uint8*)bw->pixels + y * bw->pitch);
+        for (int x = 0; x < bw->w; x++) ink += pixel_is_ink(row[x]);
+    }
+    return (double)ink / ((double)bw->w * bw->h);
+}
+
+int main(int argc, char* argv[])
+{
+    static char paths[MAX_IMAGES][512];
+    int n = 0;
+    int repeats = 3;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) repeats = atoi(argv[++i]);
+        else n = add_path(paths, n, argv[i]);
+    }
+    if (n == 0) n = add_path(paths, n, "data");
+    if (n == 0) errx(EXIT_FAILURE, "[BENCH] No .bmp image found");
+    if (repeats < 1) repeats = 1;
+    qsort(paths, n, sizeof(paths[0]), cmp_paths);
+
+    const BinarizeMethod methods[] = { BINARIZE_ISODATA, BINARIZE_SAUVOLA, BINARIZE_BRADLEY };
+    const int n_methods = sizeof(methods) / sizeof(methods[0]);
+    double total_ms[3] = {0};
+    int grids[3] = {0};
+    double total_mp = 0;
+
+    // the stage logs must not count in the measure
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+
+    printf("[BENCH] %d images x %d\n", n, repeats);
+    for (int i = 0; i < n; i++) {
+        SDL_Surface* src = SDL_LoadBMP(paths[i]);
+        if (!src) {
+            fprintf(stderr, "[BENCH] Cannot load %s: %s\n", paths[i], SDL_GetError());
+            continue;
+        }
+        double mp = src->w * (double)src->h / 1e6;
+        total_mp += mp;
+        printf("[BENCH] %s (%dx%d)\n", paths[i], src->w, src->h);
+
+        for (int m = 0; m < n_methods; m++) {
+            fflush(stdout);
+            dup2(devnull, STDOUT_FILENO);
+
+            SDL_Surface* bw = NULL;
+            double t0 = now_ms();
+            for (int r = 0; r < repeats; r++) {
+                SDL_FreeSurface(bw);
+                bw = binarize_surface(src, methods[m], NULL);
+            }
+            double ms = (now_ms() - t0) / repeats;
+
+            int gx = 0, gy = 0, gw = 0, gh = 0;
+            SDL_Surface* grid = NULL;
+            double t1 = now_ms();
+            for (int r = 0; r < repeats && bw; r++) {
+                SDL_FreeSurface(grid);
+                grid = extract_grid(bw, &gx, &gy, &gw, &gh, NULL);
+            }
+            double grid_ms = (now_ms() - t1) / repeats;
+
+            fflush(stdout);
+            dup2(saved_stdout, STDOUT_FILENO);
+
+            total_ms[m] += ms;
+            if (grid) grids[m]++;
+            printf("[BENCH]   %-8s %8.1f ms %7.1f ms/MP  ink %5.1f%%  grid %6.2f ms %s",
+                   binarize_method_name(methods[m]), ms, ms / mp,
+                   bw ? 100.0 * ink_ratio(bw) : 0.0, grid_ms, grid ? "" : "not found\n");
+            if (grid) printf("%dx%d at (%d,%d)\n", gw, gh, gx, gy);
+
+            SDL_FreeSurface(grid);
+            SDL_FreeSurface(bw);
+        }
+        SDL_FreeSurface(src);
+    }
+
+    close(saved_stdout);
+    close(devnull);
+
+    printf("[BENCH] total\n");
+    for (int m = 0; m < n_methods; m++) {
+        printf("[BENCH]   %-8s %8.1f ms %7.1f ms/MP  grids found %d/%d\n",
+               binarize_method_name(methods[m]), total_ms[m],
+               total_mp > 0 ? total_ms[m] / total_mp : 0.0, grids[m], n);
+    }
+    return 0;
+}
@@ -0,0 +1,341 @@
+#include "bitmap.h"
+#include <stdlib.h>
+#include <string.h>
+
+int bitmap_init(Bitmap* bm, int w, int h) {
+    return bitmap_init_in(bm, w, h, NULL);
+}
+
+int bitmap_init_in(Bitmap* bm, int w, int h, Arena* arena) {
+    bm->w = w;
+    bm->h = h;
+    bm->words = (w + 63) / 64;
+    bm->arena = arena;
+    bm->bits = (uint64_t*)arena_calloc(arena, (size_t)bm->words * (h > 0 ? h : 1) + 1, sizeof(uint64_t));
+    return bm->bits ? 0 : -1;
+}
+
+void bitmap_free(Bitmap* bm) {
+    arena_dealloc(bm->arena, bm->bits);
+    bm->bits = NULL;
+    bm->w = bm->h = bm->words = 0;
+}
+
+int bitmap_from_surface(Bitmap* bm, SDL_Surface* s) {
+    return bitmap_from_surface_in(bm, s, NULL);
+}
+
+int bitmap_from_surface_in(Bitmap* bm, SDL_Surface* s, Arena* arena) {
+    if (!s) return -1;
+
+    SDL_Surface* argb = s;
+    if (s->format->format != SDL_PIXELFORMAT_ARGB8888) {
+        argb = SDL_ConvertSurfaceFormat(s, SDL_PIXELFORMAT_ARGB8888, 0);
+        if (!argb) return -1;
+    }
+    if (bitmap_init_in(bm, argb->w, argb->h, arena) != 0) {
+        if (argb != s) SDL_FreeSurface(argb);
+        return -1;
+    }
+
+    if (SDL_MUSTLOCK(argb)) SDL_LockSurface(argb);
+    for (int y = 0; y < argb->h; y++) {
+        const Uint32* src = (const Uint32*)((const Uint8*)argb->pixels + y * argb->pitch);
+        uint64_t* dst = bm->bits + (size_t)y * bm->words;
+        for (int k = 0; k < bm->words; k++) {
+            int x0 = k * 64;
+            int n = argb->w - x0 < 64 ? argb->w - x0 : 64;
+            uint64_t word = 0;
+            for (int i = 0; i < n; i++)
+                word |= (uint64_t)pixel_is_ink(src[x0 + i]) << i;
+            dst[k] = word;
+        }
+    }
+    if (SDL_MUSTLOCK(argb)) SDL_UnlockSurface(argb);
+
+    if (argb != s) SDL_FreeSurface(argb);
+    return 0;
+}
+
+void bitmap_blit(const Bitmap* bm, int x, int y, int w, int h,
+                 SDL_Surface* dst, int dst_x, int dst_y) {
+    // clip to dst; the source side is handled per pixel
+    if (dst_x < 0) { x -= dst_x; w += dst_x; dst_x = 0; }
+    if (dst_y < 0) { y -= dst_y; h += dst_y; dst_y = 0; }
+    if (dst_x + w > dst->w) w = dst->w - dst_x;
+    if (dst_y + h > dst->h) h = dst->h - dst_y;
+    if (w <= 0 || h <= 0) return;
+
+    if (SDL_MUSTLOCK(dst)) SDL_LockSurface(dst);
+    for (int dy = 0; dy < h; dy++) {
+        Uint32* out = (Uint32*)((Uint8*)dst->pixels + (dst_y + dy) * dst->pitch) + dst_x;
+        int sy = y + dy;
+        if (sy < 0 || sy >= bm->h) {
+            for (int dx = 0; dx < w; dx++) out[dx] = 0xFFFFFFFF;
+            continue;
+        }
+        const uint64_t* row = bitmap_row(bm, sy);
+        for (int dx = 0; dx < w; dx++) {
+            int sx = x + dx;
+            int ink = sx >= 0 && sx < bm->w && ((row[sx >> 6] >> (sx & 63)) & 1);
+            out[dx] = ink ? 0xFF000000 : 0xFFFFFFFF;
+        }
+    }
+    if (SDL_MUSTLOCK(dst)) SDL_UnlockSurface(dst);
+}
+
+SDL_Surface* bitmap_to_surface(const Bitmap* bm, int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return NULL;
+    SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (s) bitmap_blit(bm, x, y, w, h, s, 0, 0);
+    return s;
+}
+
+int bitmap_count_span(const Bitmap* bm, int y, int x0, int x1) {
+    if (x0 < 0) x0 = 0;
+    if (x1 > bm->w) x1 = bm->w;
+    if (y < 0 || y >= bm->h || x0 >= x1) return 0;
+
+    const uint64_t* row = bitmap_row(bm, y);
+    int first = x0 >> 6, last = (x1 - 1) >> 6;
+    uint64_t head = ~(uint64_t)0 << (x0 & 63);
+    uint64_t tail = ~(uint64_t)0 >> (63 - ((x1 - 1) & 63));
+    if (first == last) return __builtin_popcountll(row[first] & head & tail);
+
+    int cnt = __builtin_popcountll(row[first] & head);
+    for (int k = first + 1; k < last; k++) cnt += __builtin_popcountll(row[k]);
+    return cnt + __builtin_popcountll(row[last] & tail);
+}
+
+long bitmap_count_region(const Bitmap* bm, int x, int y, int w, int h) {
+    int y0 = y < 0 ? 0 : y;
+    int y1 = y + h > bm->h ? bm->h : y + h;
+    long cnt = 0;
+    for (int r = y0; r < y1; r++) cnt += bitmap_count_span(bm, r, x, x + w);
+    return cnt;
+}
+
+// row |= row shifted by s pixels toward higher x. Words are visited from the
+// top so every read sees the old value.
+static void row_or_shift_up(uint64_t* row, int words, int s) {
+    int q = s >> 6, r = s & 63;
+    for (int k = words - 1; k >= q; k--) {
+        uint64_t v = row[k - q] << r;
+        if (r && k - q > 0) v |= row[k - q - 1] >> (64 - r);
+        row[k] |= v;
+    }
+}
+
+// row |= row shifted by s pixels toward lower x (words visited from the bottom)
+static void row_or_shift_down(uint64_t* row, int words, int s) {
+    int q = s >> 6, r = s & 63;
+    for (int k = 0; k + q < words; k++) {
+        uint64_t v = row[k + q] >> r;
+        if (r && k + q + 1 < words) v |= row[k + q + 1] << (64 - r);
+        row[k] |= v;
+    }
+}
+
+// Shifts that spread a pixel over the r next ones by doubling: a pixel holding
+// the OR of c pixels, ORed with its copy shifted by c, holds the OR of 2c; the
+// last, shorter shift tops up to exactly r + 1. Returns their number.
+static int spread_shifts(int r, int* shifts) {
+    int steps = 0;
+    for (int covered = 1; covered < r + 1; ) {
+        int s = covered * 2 <= r + 1 ? covered : r + 1 - covered;
+        shifts[steps++] = s;
+        covered += s;
+    }
+    return steps;
+}
+
+// Horizontal dilation by any r, one row at a time
+static void dilate_rows_long(Bitmap* bm, int r) {
+    int shifts[32];
+    int steps = spread_shifts(r, shifts);
+    for (int y = 0; y < bm->h; y++) {
+        uint64_t* row = bm->bits + (size_t)y * bm->words;
+        for (int j = 0; j < steps; j++) row_or_shift_up(row, bm->words, shifts[j]);
+        // the padding bits past w must stay 0, or the left spread would pull them in
+        if (bm->w & 63) row[bm->words - 1] &= ((uint64_t)1 << (bm->w & 63)) - 1;
+        for (int j = 0; j < steps; j++) row_or_shift_down(row, bm->words, shifts[j]);
+    }
+}
+
+// Spreads of a word by r < 64 within itself: *up = OR of the word shifted up
+// by 0..r, *down the same downward
+static inline void spread_word(uint64_t v, const int* shifts, uint64_t* up, uint64_t* down) {
+    uint64_t u = v, d = v;
+    for (int j = 0; j < 6; j++) {
+        u |= u << shifts[j];
+        d |= d >> shifts[j];
+    }
+    *up = u;
+    *down = d;
+}
+
+// Horizontal dilation by r < 64: each word is spread within itself, then takes
+// what spills into it from its neighbours: from word k - 1 the pixels within r
+// of its top (top r bits of its down spread), from word k + 1 those within r of
+// its bottom (bottom r bits of its up spread). The spreads of a row are rolled
+// along in registers, each word's computed once.
+static void dilate_rows_short(Bitmap* bm, int r) {
+    // r < 64 takes at most 6 shifts; the unused ones shift by 0
+    int shifts[8] = { 0 };
+    spread_shifts(r, shifts);
+    int words = bm->words;
+
+    uint64_t tail = bm->w & 63 ? ((uint64_t)1 << (bm->w & 63)) - 1 : ~(uint64_t)0;
+    for (int y = 0; y < bm->h; y++) {
+        uint64_t* row = bm->bits + (size_t)y * words;
+        uint64_t prev_down = 0, up, down;
+        spread_word(row[0], shifts, &up, &down);
+        for (int k = 0; k < words; k++) {
+            uint64_t next_up = 0, next_down = 0;
+            if (k + 1 < words) spread_word(row[k + 1], shifts, &next_up, &next_down);
+            row[k] = up | down | prev_down >> (64 - r) | next_up << (64 - r);
+            prev_down = down;
+            up = next_up;
+            down = next_down;
+        }
+        row[words - 1] &= tail;
+    }
+}
+
+// Vertical dilation of src by r into dst (van Herk / Gil-Werman). The rows,
+// padded with r blank rows at both ends, are cut in blocks of L = 2r + 1. The
+// window of output row y is padded rows [y, y + L): for y on a block start it
+// is that block, otherwise the end of block B (its suffix OR from y) and the
+// start of block B + 1 (its prefix OR up to y + L - 1). So each block needs its
+// suffix ORs (L rows) and the running prefix OR of the next one: three ORs per
+// word whatever r, in a buffer of L + 1 rows. Returns 0, or -1 if out of memory.
+static int dilate_cols(const Bitmap* src, int r, Bitmap* dst, Arena* scratch) {
+    int L = 2 * r + 1;
+    int rows = src->h + 2 * r;
+    int words = src->words;
+    uint64_t* suf = (uint64_t*)arena_alloc(scratch, sizeof(uint64_t) * (size_t)(L + 1) * words);
+    if (!suf) return -1;
+    uint64_t* pre = suf + (size_t)L * words;
+
+    for (int b = 0; b < src->h; b += L) {
+        // suffix ORs of block [b, b + L)
+        for (int i = L - 1; i >= 0; i--) {
+            uint64_t* cur = suf + (size_t)i * words;
+            int in = b + i - r;
+            if (in >= 0 && in < src->h) memcpy(cur, bitmap_row(src, in), sizeof(uint64_t) * words);
+            else memset(cur, 0, sizeof(uint64_t) * words);
+            if (i + 1 < L)
+                for (int k = 0; k < words; k++) cur[k] |= cur[k + words];
+        }
+
+        memcpy(dst->bits + (size_t)b * words, suf, sizeof(uint64_t) * words);
+        memset(pre, 0, sizeof(uint64_t) * words);
+        for (int j = 0; j + 1 < L && b + 1 + j < src->h; j++) {
+            int in = b + L + j - r;
+            if (in < rows - 2 * r) {
+                const uint64_t* row = bitmap_row(src, in);
+                for (int k = 0; k < words; k++) pre[k] |= row[k];
+            }
+            uint64_t* out = dst->bits + (size_t)(b + 1 + j) * words;
+            const uint64_t* s = suf + (size_t)(1 + j) * words;
+            for (int k = 0; k < words; k++) out[k] = s[k] | pre[k];
+        }
+    }
+    arena_dealloc(scratch, suf);
+    return 0;
+}
+
+int bitmap_dilate(const Bitmap* src, int rx, int ry, Bitmap* dst, Arena* arena) {
+    if (bitmap_init_in(dst, src->w, src->h, arena) != 0) return -1;
+    if (dst->words == 0) return 0;
+
+    int err = 0;
+    if (ry > 0) err = dilate_cols(src, ry, dst, arena);
+    else memcpy(dst->bits, src->bits, sizeof(uint64_t) * (size_t)src->words * src->h);
+    if (!err && rx >= 64) dilate_rows_long(dst, rx);
+    else if (!err && rx > 0) dilate_rows_short(dst, rx);
+    if (err) {
+        bitmap_free(dst);
+        return -1;
+    }
+    return 0;
+}
+
+int bitmap_ink_bounds(const Bitmap* bm, int x, int y, int w, int h,
+                      int* left, int* top, int* right, int* bottom) {
+    int x0 = x < 0 ? 0 : x, x1 = x + w > bm->w ? bm->w : x + w;
+    int y0 = y < 0 ? 0 : y, y1 = y + h > bm->h ? bm->h : y + h;
+    if (x0 >= x1 || y0 >= y1) return 0;
+
+    int k0 = x0 >> 6, k1 = (x1 - 1) >> 6;
+    uint64_t head = ~(uint64_t)0 << (x0 & 63);
+    uint64_t tail = ~(uint64_t)0 >> (63 - ((x1 - 1) & 63));
+
+    int t = -1, b = -1;
+    int l = x1, r = x0;
+    for (int yy = y0; yy < y1; yy++) {
+        const uint64_t* row = bitmap_row(bm, yy);
+        int first = -1, last = -1;
+        uint64_t vf = 0, vl = 0;
+        for (int k = k0; k <= k1; k++) {
+            uint64_t v = row[k];
+            if (k == k0) v &= head;
+            if (k == k1) v &= tail;
+            if (!v) continue;
+            if (first < 0) { first = k; vf = v; }
+            last = k;
+            vl = v;
+        }
+        if (first < 0) continue;
+
+        if (t < 0) t = yy;
+        b = yy + 1;
+        int lx = first * 64 + __builtin_ctzll(vf);
+        int rx = last * 64 + 64 - __builtin_clzll(vl);
+        if (lx < l) l = lx;
+        if (rx > r) r = rx;
+    }
+    if (t < 0) return 0;
+
+    *left = l;
+    *top = t;
+    *right = r;
+    *bottom = b;
+    return 1;
+}
+
+// Pixels [x, x + 64) of a row, 0 past its end (x >= 0)
+static inline uint64_t row_bits(const uint64_t* row, int words, int x) {
+    int k = x >> 6, s = x & 63;
+    uint64_t v = k < words ? row[k] >> s : 0;
+    if (s && k + 1 < words) v |= row[k + 1] << (64 - s);
+    return v;
+}
+
+void bitmap_copy_region(const Bitmap* src, int x, int y, int w, int h,
+                        Bitmap* dst, int dst_x, int dst_y) {
+    // clip the source, then the destination, moving both sides together
+    if (x < 0) { dst_x -= x; w += x; x = 0; }
+    if (y < 0) { dst_y -= y; h += y; y = 0; }
+    if (x + w > src->w) w = src->w - x;
+    if (y + h > src->h) h = src->h - y;
+    if (dst_x < 0) { x -= dst_x; w += dst_x; dst_x = 0; }
+    if (dst_y < 0) { y -= dst_y; h += dst_y; dst_y = 0; }
+    if (dst_x + w > dst->w) w = dst->w - dst_x;
+    if (dst_y + h > dst->h) h = dst->h - dst_y;
+    if (w <= 0 || h <= 0) return;
+
+    int k0 = dst_x >> 6, k1 = (dst_x + w - 1) >> 6;
+    for (int r = 0; r < h; r++) {
+        const uint64_t* in = bitmap_row(src, y + r);
+        uint64_t* out = dst->bits + (size_t)(dst_y + r) * dst->words;
+        for (int k = k0; k <= k1; k++) {
+            // destination pixels [d0, d1) of word k
+            int d0 = k * 64 > dst_x ? k * 64 : dst_x;
+            int d1 = k * 64 + 64 < dst_x + w ? k * 64 + 64 : dst_x + w;
+            uint64_t v = row_bits(in, src->words, x + d0 - dst_x);
+            if (d1 - d0 < 64) v &= ((uint64_t)1 << (d1 - d0)) - 1;
+            out[k] |= v << (d0 - k * 64);
+        }
+    }
+}
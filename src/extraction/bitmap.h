@@ -0,0 +1,87 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stdint.h>
+#include <SDL2/SDL.h>
+#include "../utils/arena.h"
+
+// Luma of an ARGB8888 pixel, as binarization computes it
+static inline uint8_t pixel_luma(Uint32 px) {
+    Uint32 r = (px >> 16) & 0xFF, g = (px >> 8) & 0xFF, b = px & 0xFF;
+    return (uint8_t)((77 * r + 150 * g + 29 * b) >> 8);
+}
+
+// The ink test of every stage after binarization. On binarize_image output
+// (pure black or white) it is exact; on anything else it splits the luma range
+// in half.
+static inline int pixel_is_ink(Uint32 px) {
+    return pixel_luma(px) < 128;
+}
+
+// 1-bit image of a binarized page: a set bit is ink. Pixel (x, y) is bit x & 63
+// of word x >> 6 of row y; every row starts on its own word and the bits past w
+// stay 0, so a row can be counted or scanned a word (64 pixels) at a time.
+typedef struct {
+    uint64_t* bits;
+    int w;
+    int h;
+    int words;      // uint64_t per row
+    Arena* arena;   // where bits come from (NULL: the heap)
+} Bitmap;
+
+// Blank (all white) w x h bitmap; returns 0, or -1 if out of memory
+int bitmap_init(Bitmap* bm, int w, int h);
+// Same, taken from arena (and given back with it)
+int bitmap_init_in(Bitmap* bm, int w, int h, Arena* arena);
+void bitmap_free(Bitmap* bm);
+
+// Packs a surface with pixel_is_ink (after conversion to ARGB8888).
+// Returns 0, or -1 on error.
+int bitmap_from_surface(Bitmap* bm, SDL_Surface* s);
+int bitmap_from_surface_in(Bitmap* bm, SDL_Surface* s, Arena* arena);
+
+// Black and white ARGB8888 copy of the w x h region at (x, y). Pixels outside
+// the bitmap come out white.
+SDL_Surface* bitmap_to_surface(const Bitmap* bm, int x, int y, int w, int h);
+
+// Same, written into the ARGB8888 surface dst at (dst_x, dst_y) (clipped to dst)
+void bitmap_blit(const Bitmap* bm, int x, int y, int w, int h,
+                 SDL_Surface* dst, int dst_x, int dst_y);
+
+static inline const uint64_t* bitmap_row(const Bitmap* bm, int y) {
+    return bm->bits + (size_t)y * bm->words;
+}
+
+static inline int bitmap_get(const Bitmap* bm, int x, int y) {
+    return (int)((bitmap_row(bm, y)[x >> 6] >> (x & 63)) & 1);
+}
+
+static inline void bitmap_set(Bitmap* bm, int x, int y) {
+    bm->bits[(size_t)y * bm->words + (x >> 6)] |= (uint64_t)1 << (x & 63);
+}
+
+// Ink pixels of row y in columns [x0, x1)
+int bitmap_count_span(const Bitmap* bm, int y, int x0, int x1);
+
+// Ink pixels of the w x h region at (x, y), clipped to the bitmap
+long bitmap_count_region(const Bitmap* bm, int x, int y, int w, int h);
+
+// dst = src dilated by a (2 rx + 1) x (2 ry + 1) rectangle: a pixel is ink when
+// some ink of src lies within rx columns and ry rows of it. Separable and done
+// a word at a time: O(log rx) shifts per word across, three ORs per word down
+// whatever ry. dst and the work buffer come from arena. Returns 0, or -1 if
+// out of memory.
+int bitmap_dilate(const Bitmap* src, int rx, int ry, Bitmap* dst, Arena* arena);
+
+// Bounding box of the ink in the w x h region at (x, y) (clipped to the
+// bitmap), in bitmap coordinates, right and bottom exclusive. Returns 0 (and
+// leaves the outputs alone) if the region is blank, 1 otherwise.
+int bitmap_ink_bounds(const Bitmap* bm, int x, int y, int w, int h,
+                      int* left, int* top, int* right, int* bottom);
+
+// dst |= the w x h region of src at (x, y), placed at (dst_x, dst_y); clipped
+// to both bitmaps. Done 64 pixels at a time whatever the alignments.
+void bitmap_copy_region(const Bitmap* src, int x, int y, int w, int h,
+                        Bitmap* dst, int dst_x, int dst_y);
+
+#endif
@@ -0,0 +1,154 @@
+#include "components.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int find_root(int* parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];  // path halving
+        i = parent[i];
+    }
+    return i;
+}
+
+// The root is the run seen first, so the roots come out in raster order
+static void join(int* parent, int a, int b) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a < b) parent[b] = a;
+    else if (b < a) parent[a] = b;
+}
+
+// Number of runs: each starts on an ink bit whose left neighbour is blank
+static int count_runs(const Bitmap* bm) {
+    long count = 0;
+    for (int y = 0; y < bm->h; y++) {
+        const uint64_t* row = bitmap_row(bm, y);
+        uint64_t carry = 0;
+        for (int k = 0; k < bm->words; k++) {
+            uint64_t v = row[k];
+            count += __builtin_popcountll(v & ~(v << 1 | carry));
+            carry = v >> 63;
+        }
+    }
+    return (int)count;
+}
+
+static void push_run(Components* cc, int* parent, int y, int x0, int x1) {
+    ComponentRun* run = &cc->runs[cc->run_count];
+    run->y = y;
+    run->x0 = x0;
+    run->x1 = x1;
+    run->label = -1;
+    parent[cc->run_count] = cc->run_count;
+    cc->run_count++;
+}
+
+// Appends the runs of row y
+static void row_runs(const Bitmap* bm, int y, Components* cc, int* parent) {
+    const uint64_t* row = bitmap_row(bm, y);
+    int start = -1;
+    for (int k = 0; k < bm->words; k++) {
+        uint64_t v = row[k];
+        int base = k * 64;
+        // alternately look for the next ink bit and the next blank bit
+        int pos = 0;
+        while (pos < 64) {
+            uint64_t rest = (start < 0 ? v : ~v) >> pos;
+            if (!rest) break;
+            pos += __builtin_ctzll(rest);
+            if (start < 0) {
+                start = base + pos;
+            } else {
+                push_run(cc, parent, y, start, base + pos);
+                start = -1;
+            }
+        }
+    }
+    // the padding bits are blank, so only a run touching w is still open
+    if (start >= 0) push_run(cc, parent, y, start, bm->w);
+}
+
+int components_find(const Bitmap* bm, Components* cc, Arena* arena) {
+    memset(cc, 0, sizeof(*cc));
+    cc->arena = arena;
+
+    // counted first, so every array is allocated once at its size
+    int runs = count_runs(bm);
+    if (runs == 0) return 0;
+    cc->runs = (ComponentRun*)arena_alloc(arena, sizeof(ComponentRun) * runs);
+    int* parent = (int*)arena_alloc(arena, sizeof(int) * runs);
+    if (!cc->runs || !parent) {
+        arena_dealloc(arena, parent);
+        components_free(cc);
+        return -1;
+    }
+
+    int prev_first = 0, prev_last = 0;  // runs of the row above
+    for (int y = 0; y < bm->h; y++) {
+        int first = cc->run_count;
+        row_runs(bm, y, cc, parent);
+        int last = cc->run_count;
+
+        // Both rows are sorted: walk them together. Runs touch (diagonals
+        // included) when each starts at most one pixel after the other ends.
+        int a = prev_first, b = first;
+        while (a < prev_last && b < last) {
+            const ComponentRun* up = &cc->runs[a];
+            const ComponentRun* cur = &cc->runs[b];
+            if (up->x0 <= cur->x1 && cur->x0 <= up->x1) join(parent, a, b);
+            if (up->x1 < cur->x1) a++;
+            else b++;
+        }
+        prev_first = first;
+        prev_last = last;
+    }
+
+    // number the roots in order, then gather the statistics
+    for (int i = 0; i < cc->run_count; i++) {
+        int root = find_root(parent, i);
+        if (root == i) cc->runs[i].label = cc->count++;
+        else cc->runs[i].label = cc->runs[root].label;
+    }
+    arena_dealloc(arena, parent);
+
+    cc->items = (Component*)arena_alloc(arena, sizeof(Component) * cc->count);
+    if (!cc->items) {
+        components_free(cc);
+        return -1;
+    }
+    int seen = 0;
+    for (int i = 0; i < cc->run_count; i++) {
+        const ComponentRun* run = &cc->runs[i];
+        Component* c = &cc->items[run->label];
+        if (run->label == seen) {
+            // first run of a new component (labels were given in run order)
+            c->x0 = run->x0;
+            c->x1 = run->x1;
+            c->y0 = run->y;
+            c->y1 = run->y + 1;
+            c->area = 0;
+            c->cx = c->cy = 0.0;
+            c->first_run = i;
+            seen++;
+        }
+        if (run->x0 < c->x0) c->x0 = run->x0;
+        if (run->x1 > c->x1) c->x1 = run->x1;
+        c->y1 = run->y + 1;
+        int len = run->x1 - run->x0;
+        c->area += len;
+        // sums of the coordinates for now: x0 + ... + (x1 - 1) along the run
+        c->cx += 0.5 * len * (run->x0 + run->x1 - 1);
+        c->cy += (double)len * run->y;
+    }
+    for (int i = 0; i < cc->count; i++) {
+        cc->items[i].cx /= cc->items[i].area;
+        cc->items[i].cy /= cc->items[i].area;
+    }
+    return 0;
+}
+
+void components_free(Components* cc) {
+    arena_dealloc(cc->arena, cc->items);
+    arena_dealloc(cc->arena, cc->runs);
+    memset(cc, 0, sizeof(*cc));
+}
@@ -0,0 +1,38 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "bitmap.h"
+
+// Connected components (8-connected) of the ink of a Bitmap, labeled in one
+// sweep over its runs: each horizontal run of ink is joined, with a union-find,
+// to the runs of the row above that touch it, and the statistics are gathered
+// per root at the end.
+
+typedef struct {
+    int x0, y0;     // bounding box, x1 and y1 exclusive
+    int x1, y1;
+    long area;      // ink pixels
+    double cx, cy;  // centroid of the ink pixels
+    int first_run;  // index of its first run in the ComponentRuns (raster order)
+} Component;
+
+// A horizontal run of ink [x0, x1) on row y, and the component it belongs to
+typedef struct {
+    int y;
+    int x0, x1;
+    int label;
+} ComponentRun;
+
+typedef struct {
+    Component* items;   // numbered in raster order of their first pixel
+    int count;
+    ComponentRun* runs; // row by row, left to right
+    int run_count;
+    Arena* arena;       // where the arrays come from (NULL: the heap)
+} Components;
+
+// The arrays are taken from arena. Returns 0, or -1 if out of memory.
+int components_find(const Bitmap* bm, Components* cc, Arena* arena);
+void components_free(Components* cc);
+
+#endif
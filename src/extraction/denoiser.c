@@ -2,28 +2,272 @@
 #include <SDL2/SDL.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-// Helper: Find median of array using bubble sort
-static Uint8 median(Uint8 a[], int size) {
-    // Simple bubble sort
-    for (int i = 0; i < size - 1; i++) {
-        for (int j = 0; j < size - i - 1; j++) {
-            if (a[j] > a[j + 1]) {
-                Uint8 tmp = a[j];
-                a[j] = a[j + 1];
-                a[j + 1] = tmp;
-            }
+#if OCR_SIMD && defined(__SSE2__)
+#define HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define HAVE_SSE2 0
+#endif
+
+static inline Uint8 min_u8(Uint8 a, Uint8 b) { return a < b ? a : b; }
+static inline Uint8 max_u8(Uint8 a, Uint8 b) { return a > b ? a : b; }
+static inline Uint8 med3_u8(Uint8 a, Uint8 b, Uint8 c) {
+    return max_u8(min_u8(a, b), min_u8(max_u8(a, b), c));
+}
+
+#if HAVE_SSE2
+static inline __m128i med3_epu8(__m128i a, __m128i b, __m128i c) {
+    return _mm_max_epu8(_mm_min_epu8(a, b), _mm_min_epu8(_mm_max_epu8(a, b), c));
+}
+#endif
+
+// 3x3 median with a sorting network:
+// each column (a, b, c) of the window is sorted into lo <= mid <= hi, then
+// median = med3(max of the 3 lo, med3 of the 3 mid, min of the 3 hi).
+// A column is shared by 3 neighbouring windows, so it is sorted once per row.
+
+// Sorts the column triples of three rows into lo / mid / hi
+static void sort_columns(const Uint8* a, const Uint8* b, const Uint8* c,
+                         Uint8* lo, Uint8* mid, Uint8* hi, int n) {
+    int x = 0;
+#if HAVE_SSE2
+    for (; x + 16 <= n; x += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + x));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + x));
+        __m128i vc = _mm_loadu_si128((const __m128i*)(c + x));
+        __m128i t = _mm_min_epu8(va, vb);
+        vb = _mm_max_epu8(va, vb);
+        va = t;
+        t = _mm_min_epu8(vb, vc);
+        vc = _mm_max_epu8(vb, vc);
+        vb = t;
+        t = _mm_min_epu8(va, vb);
+        vb = _mm_max_epu8(va, vb);
+        va = t;
+        _mm_storeu_si128((__m128i*)(lo + x), va);
+        _mm_storeu_si128((__m128i*)(mid + x), vb);
+        _mm_storeu_si128((__m128i*)(hi + x), vc);
+    }
+#endif
+    for (; x < n; x++) {
+        Uint8 va = a[x], vb = b[x], vc = c[x];
+        Uint8 t = min_u8(va, vb); vb = max_u8(va, vb); va = t;
+        t = min_u8(vb, vc); vc = max_u8(vb, vc); vb = t;
+        t = min_u8(va, vb); vb = max_u8(va, vb); va = t;
+        lo[x] = va;
+        mid[x] = vb;
+        hi[x] = vc;
+    }
+}
+
+// out[x] = median of the window made of columns x, x+1, x+2
+static void merge_columns(const Uint8* lo, const Uint8* mid, const Uint8* hi, Uint8* out, int n) {
+    int x = 0;
+#if HAVE_SSE2
+    for (; x + 16 <= n; x += 16) {
+        __m128i l = _mm_max_epu8(_mm_max_epu8(_mm_loadu_si128((const __m128i*)(lo + x)),
+                                              _mm_loadu_si128((const __m128i*)(lo + x + 1))),
+                                 _mm_loadu_si128((const __m128i*)(lo + x + 2)));
+        __m128i m = med3_epu8(_mm_loadu_si128((const __m128i*)(mid + x)),
+                              _mm_loadu_si128((const __m128i*)(mid + x + 1)),
+                              _mm_loadu_si128((const __m128i*)(mid + x + 2)));
+        __m128i h = _mm_min_epu8(_mm_min_epu8(_mm_loadu_si128((const __m128i*)(hi + x)),
+                                              _mm_loadu_si128((const __m128i*)(hi + x + 1))),
+                                 _mm_loadu_si128((const __m128i*)(hi + x + 2)));
+        _mm_storeu_si128((__m128i*)(out + x), med3_epu8(l, m, h));
+    }
+#endif
+    for (; x < n; x++) {
+        Uint8 l = max_u8(max_u8(lo[x], lo[x + 1]), lo[x + 2]);
+        Uint8 m = med3_u8(mid[x], mid[x + 1], mid[x + 2]);
+        Uint8 h = min_u8(min_u8(hi[x], hi[x + 1]), hi[x + 2]);
+        out[x] = med3_u8(l, m, h);
+    }
+}
+
+// Larger windows: Huang's sliding histogram. Moving one pixel right removes a
+// column of the window and adds another (2r+1 updates each), and the median is
+// tracked from the previous one by counting the values below it.
+// rows[dy + radius] is row y + dy of the source.
+static void median_huang_row(const Uint8* const* rows, Uint8* out, int w, int radius) {
+    int size = 2 * radius + 1;
+    int half = size * size / 2;     // rank of the median in the window
+
+    int hist[256] = {0};
+    for (int dy = 0; dy < size; dy++) {
+        for (int x = 0; x < size; x++) hist[rows[dy][x]]++;
+    }
+
+    // m = median, below = number of values < m
+    int m = 0, below = 0;
+    while (below + hist[m] <= half) below += hist[m++];
+    out[radius] = (Uint8)m;
+
+    for (int x = radius + 1; x < w - radius; x++) {
+        for (int dy = 0; dy < size; dy++) {
+            Uint8 leaving = rows[dy][x - radius - 1];
+            Uint8 entering = rows[dy][x + radius];
+            hist[leaving]--;
+            hist[entering]++;
+            below -= (leaving < m);
+            below += (entering < m);
         }
+        while (below > half) below -= hist[--m];
+        while (below + hist[m] <= half) below += hist[m++];
+        out[x] = (Uint8)m;
     }
-    return a[size / 2];
 }
 
-SDL_Surface* denoise_image(SDL_Surface* input) {
+// Rows of a plane held in a buffer that starts at plane row "top"
+typedef struct {
+    Uint8* data;
+    int top;
+} RowSpan;
+
+static inline Uint8* span_row(RowSpan span, int y, int w) {
+    return span.data + (size_t)(y - span.top) * w;
+}
+
+// Filters plane rows [y0, y1) of src into dst. Rows and columns closer than
+// radius to the plane border are copied. cols: 3*w bytes of scratch.
+static void median_rows(RowSpan src, RowSpan dst, int w, int h, int radius,
+                        int y0, int y1, Uint8* cols) {
+    int filter = w > 2 * radius && h > 2 * radius;
+    const Uint8* rows[2 * MEDIAN_MAX_RADIUS + 1];
+
+    for (int y = y0; y < y1; y++) {
+        const Uint8* in = span_row(src, y, w);
+        Uint8* out = span_row(dst, y, w);
+        if (!filter || y < radius || y >= h - radius) {
+            memcpy(out, in, w);
+            continue;
+        }
+
+        memcpy(out, in, radius);
+        memcpy(out + w - radius, in + w - radius, radius);
+        if (radius == 1) {
+            sort_columns(in - w, in, in + w, cols, cols + w, cols + 2 * w, w);
+            merge_columns(cols, cols + w, cols + 2 * w, out + 1, w - 2);
+        } else {
+            for (int dy = -radius; dy <= radius; dy++) rows[dy + radius] = span_row(src, y + dy, w);
+            median_huang_row(rows, out, w, radius);
+        }
+    }
+}
+
+int median_filter_plane(const Uint8* src, Uint8* dst, int w, int h, int radius) {
+    if (radius < 1) radius = 1;
+    if (radius > MEDIAN_MAX_RADIUS) radius = MEDIAN_MAX_RADIUS;
+
+    Uint8* cols = (Uint8*)malloc(3 * (size_t)w);
+    if (!cols) return -1;
+    RowSpan in = { (Uint8*)src, 0 };
+    RowSpan out = { dst, 0 };
+    median_rows(in, out, w, h, radius, 0, h, cols);
+    free(cols);
+    return 0;
+}
+
+// Band of rows of one plane, filtered by one thread-pool task
+typedef struct {
+    const Uint8* src;   // channel planes, w*h bytes apart
+    Uint8* dst;
+    int w, h;
+    int radius;
+    int passes;
+    int band_rows;
+    int n_bands;
+    int* status;        // per task: 0, or -1 if out of memory
+} MedianJob;
+
+static void median_band_task(void* arg, int task) {
+    MedianJob* job = (MedianJob*)arg;
+    int w = job->w, h = job->h, r = job->radius, passes = job->passes;
+    size_t plane_size = (size_t)w * h;
+    int channel = task / job->n_bands;
+    int y0 = (task % job->n_bands) * job->band_rows;
+    int y1 = y0 + job->band_rows < h ? y0 + job->band_rows : h;
+
+    RowSpan src = { (Uint8*)job->src + channel * plane_size, 0 };
+    RowSpan dst = { job->dst + channel * plane_size, 0 };
+
+    // Pass k only has to produce the rows that pass k+1 reads: the band plus a
+    // halo of r * (passes - k) rows on each side, clamped to the image. The
+    // intermediate passes stay in two band-sized buffers.
+    int halo = r * (passes - 1);
+    int a0 = y0 - halo > 0 ? y0 - halo : 0;
+    int a1 = y1 + halo < h ? y1 + halo : h;
+    size_t span_size = (size_t)(a1 - a0) * w;
+
+    Uint8* scratch = (Uint8*)malloc(3 * (size_t)w + (passes > 1 ? 2 * span_size : 0));
+    if (!scratch) {
+        job->status[task] = -1;
+        return;
+    }
+    Uint8* cols = scratch;
+    RowSpan ping = { scratch + 3 * w, a0 };
+    RowSpan pong = { scratch + 3 * w + span_size, a0 };
+
+    RowSpan in = src;
+    for (int pass = 1; pass <= passes; pass++) {
+        int extra = r * (passes - pass);
+        int p0 = y0 - extra > 0 ? y0 - extra : 0;
+        int p1 = y1 + extra < h ? y1 + extra : h;
+        RowSpan out = (pass == passes) ? dst : ((pass & 1) ? ping : pong);
+
+        median_rows(in, out, w, h, r, p0, p1, cols);
+        in = out;
+    }
+
+    free(scratch);
+    job->status[task] = 0;
+}
+
+// Filters `channels` planes in bands across the pool
+static int median_planes(const Uint8* src, Uint8* dst, int channels, int w, int h,
+                         int radius, int passes, ThreadPool* pool) {
+    int threads = thread_pool_size(pool);
+
+    // A few bands per thread to even out the load; tall enough that the halos
+    // re-filtered by neighbouring bands stay a small fraction of the work
+    int n_bands = threads > 1 ? 4 * threads : 1;
+    int band_rows = (h + n_bands - 1) / n_bands;
+    if (band_rows < 16 * radius * passes) band_rows = 16 * radius * passes;
+    n_bands = (h + band_rows - 1) / band_rows;
+
+    MedianJob job;
+    job.src = src;
+    job.dst = dst;
+    job.w = w;
+    job.h = h;
+    job.radius = radius;
+    job.passes = passes;
+    job.band_rows = band_rows;
+    job.n_bands = n_bands;
+    job.status = (int*)calloc(channels * n_bands, sizeof(int));
+    if (!job.status) return -1;
+
+    thread_pool_run(pool, channels * n_bands, median_band_task, &job);
+
+    int ret = 0;
+    for (int i = 0; i < channels * n_bands; i++) {
+        if (job.status[i] != 0) ret = -1;
+    }
+    free(job.status);
+    return ret;
+}
+
+SDL_Surface* denoise_image_passes(SDL_Surface* input, int radius, int passes, ThreadPool* pool) {
     if (!input) {
         fprintf(stderr, "[denoiser] Input surface is NULL\n");
         return NULL;
     }
-    
+    if (radius < 1) radius = 1;
+    if (radius > MEDIAN_MAX_RADIUS) radius = MEDIAN_MAX_RADIUS;
+    if (passes < 1) passes = 1;
+
     SDL_Surface* input_32 = NULL;
     if (input->format->format != SDL_PIXELFORMAT_ARGB8888) {
         input_32 = SDL_ConvertSurfaceFormat(input, SDL_PIXELFORMAT_ARGB8888, 0);
@@ -34,7 +278,7 @@ SDL_Surface* denoise_image(SDL_Surface* input) {
     } else {
         input_32 = input;
     }
-    
+
     // Create output surface
     SDL_Surface* output = SDL_CreateRGBSurface(
         0,
@@ -45,77 +289,83 @@ SDL_Surface* denoise_image(SDL_Surface* input) {
         input_32->format->Bmask,
         input_32->format->Amask
     );
-    
-    if (!output) {
+
+    int w = input_32->w;
+    int h = input_32->h;
+    size_t n = (size_t)w * h;
+
+    // R, G, B planes in, filtered planes out
+    Uint8* planes = output ? (Uint8*)malloc(6 * n) : NULL;
+    if (!planes) {
         fprintf(stderr, "[denoiser] Surface creation error: %s\n", SDL_GetError());
+        SDL_FreeSurface(output);
         if (input_32 != input) SDL_FreeSurface(input_32);
         return NULL;
     }
-    
+
     SDL_LockSurface(input_32);
     SDL_LockSurface(output);
-    
-    int w = input_32->w;
-    int h = input_32->h;
-    
-    // Copy border pixels as-is
-    Uint32* in_pixels = (Uint32*)input_32->pixels;
-    Uint32* out_pixels = (Uint32*)output->pixels;
-    
-    // Top and bottom rows
-    for (int x = 0; x < w; x++) {
-        out_pixels[x] = in_pixels[x]; // Top row
-        out_pixels[(h - 1) * w + x] = in_pixels[(h - 1) * w + x]; // Bottom row
-    }
-    
-    // Left and right columns
+
+    // Border pixels are copied as-is, the rest is overwritten below
+    int gray = 1;
     for (int y = 0; y < h; y++) {
+        const Uint32* in_row = (const Uint32*)((const Uint8*)input_32->pixels + y * input_32->pitch);
         Uint32* out_row = (Uint32*)((Uint8*)output->pixels + y * output->pitch);
-        Uint32* in_row = (Uint32*)((Uint8*)input_32->pixels + y * input_32->pitch);
-        out_row[0] = in_row[0]; // Left column
-        out_row[w - 1] = in_row[w - 1]; // Right column
-    }
-    
-    // Apply 3x3 median filter to interior pixels
-    for (int y = 1; y < h - 1; y++) {
-        for (int x = 1; x < w - 1; x++) {
-            Uint8 r[9], g[9], b[9];
-            int idx = 0;
-            
-            // Collect 3x3 neighborhood
-            for (int dy = -1; dy <= 1; dy++) {
-                Uint32* row = (Uint32*)((Uint8*)input_32->pixels + (y + dy) * input_32->pitch);
-                
-                for (int dx = -1; dx <= 1; dx++) {
-                    Uint32 pixel = row[x + dx];
-                    
-                    Uint8 R, G, B;
-                    SDL_GetRGB(pixel, input_32->format, &R, &G, &B);
-                    
-                    r[idx] = R;
-                    g[idx] = G;
-                    b[idx] = B;
-                    idx++;
-                }
-            }
-            
-            // Apply median to each channel
+        memcpy(out_row, in_row, (size_t)w * 4);
+
+        Uint8* r = planes + (size_t)y * w;
+        Uint8* g = r + n;
+        Uint8* b = g + n;
+        for (int x = 0; x < w; x++) {
+            Uint32 pixel = in_row[x];
+            r[x] = (pixel >> 16) & 0xFF;
+            g[x] = (pixel >> 8) & 0xFF;
+            b[x] = pixel & 0xFF;
+            gray &= (r[x] == g[x]) & (g[x] == b[x]);
+        }
+    }
+
+    // Already binarized / grayscale input: one plane instead of three
+    int channels = gray ? 1 : 3;
+    int ret = median_planes(planes, planes + 3 * n, channels, w, h, radius, passes, pool);
+
+    if (ret == 0) {
+        const Uint8* r = planes + 3 * n;
+        const Uint8* g = gray ? r : r + n;
+        const Uint8* b = gray ? r : r + 2 * n;
+        for (int y = radius; y < h - radius; y++) {
             Uint32* out_row = (Uint32*)((Uint8*)output->pixels + y * output->pitch);
-            out_row[x] = SDL_MapRGB(output->format,
-                                    median(r, 9),
-                                    median(g, 9),
-                                    median(b, 9));
+            size_t row = (size_t)y * w;
+            for (int x = radius; x < w - radius; x++) {
+                out_row[x] = 0xFF000000u | ((Uint32)r[row + x] << 16)
+                           | ((Uint32)g[row + x] << 8) | b[row + x];
+            }
         }
     }
-    
+
     SDL_UnlockSurface(input_32);
     SDL_UnlockSurface(output);
-    
+    free(planes);
+
     if (input_32 != input) {
         SDL_FreeSurface(input_32);
     }
-    
-    printf("[denoiser] ✓ Median filter applied (%dx%d)\n", w, h);
-    
+    if (ret != 0) {
+        fprintf(stderr, "[denoiser] Out of memory\n");
+        SDL_FreeSurface(output);
+        return NULL;
+    }
+
+    printf("[denoiser] ✓ Median filter applied (%dx%d, %dx%d window x%d, %d thread(s)%s)\n",
+           w, h, 2 * radius + 1, 2 * radius + 1, passes, thread_pool_size(pool),
+           gray ? ", grayscale" : "");
+
+    return output;
+}
+
+SDL_Surface* denoise_image(SDL_Surface* input) {
+    ThreadPool* pool = thread_pool_create(0);
+    SDL_Surface* output = denoise_image_passes(input, 1, 1, pool);
+    thread_pool_destroy(pool);
     return output;
 }
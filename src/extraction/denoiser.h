@@ -2,7 +2,24 @@
 #define DENOISER_H
 
 #include <SDL2/SDL.h>
+#include "../utils/thread_pool.h"
 
+#define MEDIAN_MAX_RADIUS 15
+
+// 3x3 median filter on each RGB channel (border pixels are kept as-is),
+// spread over a temporary pool of thread_pool_default_size() threads
 SDL_Surface* denoise_image(SDL_Surface* input);
 
+// (2*radius+1)² median filter applied `passes` times in a row. The image is cut
+// into horizontal bands filtered by the pool's threads (NULL = current thread);
+// each band carries a halo of radius * passes rows so the passes run back to
+// back without a full intermediate image. Grayscale input is filtered as one
+// channel.
+SDL_Surface* denoise_image_passes(SDL_Surface* input, int radius, int passes, ThreadPool* pool);
+
+// Median filter of one 8-bit plane (stride = w) on the current thread. The
+// border of width radius is copied from src. radius 1 uses a sorting network,
+// larger radii a sliding histogram. Returns 0, or -1 if out of memory.
+int median_filter_plane(const Uint8* src, Uint8* dst, int w, int h, int radius);
+
 #endif
@@ -1,107 +1,110 @@
 #include "extract_grid.h"
+#include "bitmap.h"
+#include "hough.h"
+#include "components.h"
 #include <SDL2/SDL.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdbool.h>
 #include <string.h>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// --- Fonctions de base ---
-
-static inline bool is_black(uint32_t px) {
-    uint8_t r = (px >> 16) & 0xFF;
-    uint8_t g = (px >> 8) & 0xFF;
-    uint8_t b = px & 0xFF;
-    // Seuil de noir assez large pour capter les gris foncés
-    return (r < 100 && g < 100 && b < 100);
-}
-
-static inline uint32_t get_pixel(SDL_Surface* s, int x, int y) {
-    if (x < 0 || y < 0 || x >= s->w || y >= s->h) return 0xFFFFFFFF;
-    return ((uint32_t*)((uint8_t*)s->pixels + y * s->pitch))[x];
-}
+// --- Détection de l'inclinaison ---
+
+// Nombre de points d'encre gardés : au-delà on n'en garde qu'une colonne sur
+// 2, 4... Moins pour la recherche grossière, plus pour le raffinement
+#define SKEW_COARSE_POINTS (1 << 14)
+#define SKEW_FINE_POINTS (1 << 16)
+
+#define SKEW_RANGE 5.0      // degrés, de chaque côté
+#define SKEW_STEP 0.5       // pas de la recherche grossière
+#define SKEW_FINE_STEP 0.05 // pas du raffinement
+#define SKEW_MAX_ANGLES 64
+
+// Vote des points pour les angles base +- range (pas step), à la fois autour de
+// 90 (lignes de texte, traits horizontaux) et de 0 (colonnes, traits verticaux) :
+// une page tournée de a penche les deux familles de a. scores[i] = netteté des
+// deux profils à l'angle base - range + i * step. Un seul passage sur les points
+// pour tous les angles. Renvoie le nombre d'angles, ou -1.
+static int skew_scores(const HoughPoints* pts, double base, double range, double step,
+                       ThreadPool* pool, Arena* scratch, double* scores) {
+    int n = (int)(2.0 * range / step + 0.5) + 1;
+    double thetas[2 * SKEW_MAX_ANGLES];
+    for (int i = 0; i < n; i++) {
+        double a = base - range + i * step;
+        thetas[i] = 90.0 + a;
+        thetas[n + i] = a;
+    }
 
-static inline void put_pixel(SDL_Surface* s, int x, int y, uint32_t px) {
-    if (x < 0 || y < 0 || x >= s->w || y >= s->h) return;
-    ((uint32_t*)((uint8_t*)s->pixels + y * s->pitch))[x] = px;
+    HoughSpace hs;
+    if (hough_init(&hs, pts, thetas, 2 * n, scratch) != 0) return -1;
+    if (hough_vote(&hs, pts, pool) != 0) {
+        hough_free(&hs);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) scores[i] = hough_sharpness(&hs, i) + hough_sharpness(&hs, n + i);
+    hough_free(&hs);
+    return n;
 }
 
-// --- Rotation (Idem) ---
-
-static double projection_variance_at_angle(SDL_Surface* bin, double angle_deg) {
-    int step = 8; // On scanne moins de pixels pour aller plus vite
-    int dsW = bin->w / step;
-    int dsH = bin->h / step;
-    if (dsW <= 0 || dsH <= 0) return 0.0;
-
-    double rad = angle_deg * M_PI / 180.0;
-    double cs = cos(rad);
-    double sn = sin(rad);
-
-    int* prof = (int*)calloc(dsH, sizeof(int));
-    double cx = dsW / 2.0, cy = dsH / 2.0;
-
-    for (int y = 0; y < dsH; y++) {
-        for (int x = 0; x < dsW; x++) {
-            double rx = (x - cx) * cs - (y - cy) * sn + cx;
-            double ry = (x - cx) * sn + (y - cy) * cs + cy;
-            int ix = (int)(rx * step + 0.5);
-            int iy = (int)(ry * step + 0.5);
-            if (ix >= 0 && iy >= 0 && ix < bin->w && iy < bin->h) {
-                if (is_black(get_pixel(bin, ix, iy))) prof[y]++;
-            }
-        }
+double detect_skew_angle(const Bitmap* page, double* confidence, ThreadPool* pool, Arena* scratch) {
+    if (confidence) *confidence = 0.0;
+
+    HoughPoints coarse = { 0 }, pts = { 0 };
+    int ok = hough_points_init(&coarse, page, SKEW_COARSE_POINTS, scratch) == 0
+          && hough_points_init(&pts, page, SKEW_FINE_POINTS, scratch) == 0;
+    double scores[SKEW_MAX_ANGLES];
+    int n = ok && pts.count > 0 ? skew_scores(&coarse, 0.0, SKEW_RANGE, SKEW_STEP, pool, scratch, scores) : -1;
+    hough_points_free(&coarse);
+    if (n <= 0) {
+        hough_points_free(&pts);
+        return 0.0;
     }
-    double mean = 0.0, var = 0.0;
-    for (int i = 0; i < dsH; i++) mean += prof[i];
-    mean /= (double)dsH;
-    for (int i = 0; i < dsH; i++) var += (prof[i] - mean) * (prof[i] - mean);
-    var /= (double)dsH;
-    free(prof);
-    return var;
-}
 
-static double detect_skew_angle(SDL_Surface* bin) {
-    double best_angle = 0.0;
-    double best_var = projection_variance_at_angle(bin, 0.0);
-    
-    // Recherche restreinte (-5 à +5 degrés suffisent souvent)
-    for (double a = -5.0; a <= 5.0; a += 1.0) {
-        if (a == 0.0) continue;
-        double v = projection_variance_at_angle(bin, a);
-        if (v > best_var) { best_var = v; best_angle = a; }
+    // 1. Recherche grossière sur [-5, +5] degrés
+    int best_i = 0;
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += scores[i];
+        if (scores[i] > scores[best_i]) best_i = i;
     }
-    // Raffinement
-    double center = best_angle;
-    for (double a = center - 0.5; a <= center + 0.5; a += 0.1) {
-        double v = projection_variance_at_angle(bin, a);
-        if (v > best_var) { best_var = v; best_angle = a; }
+    double best_angle = -SKEW_RANGE + best_i * SKEW_STEP;
+
+    // Confiance : contraste du pic face à la moyenne des angles essayés
+    // (0 = profil identique quel que soit l'angle, proche de 1 = pic net)
+    if (confidence) *confidence = 1.0 - (sum / n) / scores[best_i];
+
+    // 2. Raffinement à un demi-pas du meilleur angle, sur l'ensemble de points
+    // plus dense : un second vote à pas fin, puis le sommet de la parabole qui
+    // passe par le meilleur angle et ses deux voisins
+    n = skew_scores(&pts, best_angle, SKEW_STEP / 2.0, SKEW_FINE_STEP, pool, scratch, scores);
+    hough_points_free(&pts);
+    if (n <= 0) return best_angle;
+
+    best_i = 0;
+    for (int i = 1; i < n; i++)
+        if (scores[i] > scores[best_i]) best_i = i;
+    double refined = best_angle - SKEW_STEP / 2.0 + best_i * SKEW_FINE_STEP;
+    if (best_i > 0 && best_i < n - 1) {
+        double l = scores[best_i - 1], c = scores[best_i], r = scores[best_i + 1];
+        double d = l - 2.0 * c + r;
+        if (d < 0.0) refined += 0.5 * (l - r) / d * SKEW_FINE_STEP;
     }
-    printf("[extract_grid] Detected Skew: %.2f degrees\n", best_angle);
-    return best_angle;
+    return refined;
 }
 
-static SDL_Surface* rotate_surface(SDL_Surface* src, double angle_deg) {
-    if (fabs(angle_deg) < 0.1) {
-        SDL_Surface* dup = SDL_CreateRGBSurfaceWithFormat(0, src->w, src->h, 32, SDL_PIXELFORMAT_ARGB8888);
-        SDL_BlitSurface(src, NULL, dup, NULL);
-        return dup;
-    }
+// Rotation au plus proche voisin : les pixels hors de l'image source restent blancs
+static int rotate_bitmap(const Bitmap* src, double angle_deg, Bitmap* dst, Arena* scratch) {
     double rad = -angle_deg * M_PI / 180.0;
     double cs = cos(rad);
     double sn = sin(rad);
     int new_w = (int)(fabs(src->w * cs) + fabs(src->h * sn));
     int new_h = (int)(fabs(src->w * sn) + fabs(src->h * cs));
-    
-    SDL_Surface* dst = SDL_CreateRGBSurfaceWithFormat(0, new_w, new_h, 32, SDL_PIXELFORMAT_ARGB8888);
-    SDL_FillRect(dst, NULL, 0xFFFFFFFF);
 
-    if (SDL_MUSTLOCK(src)) SDL_LockSurface(src);
-    if (SDL_MUSTLOCK(dst)) SDL_LockSurface(dst);
+    if (bitmap_init_in(dst, new_w, new_h, scratch) != 0) return -1;
 
     double cx_src = src->w / 2.0, cy_src = src->h / 2.0;
     double cx_dst = new_w / 2.0, cy_dst = new_h / 2.0;
@@ -113,126 +116,53 @@ static SDL_Surface* rotate_surface(SDL_Surface* src, double angle_deg) {
             double src_x = dx * cs + dy * sn + cx_src;
             double src_y = -dx * sn + dy * cs + cy_src;
             if (src_x >= 0 && src_x < src->w && src_y >= 0 && src_y < src->h) {
-                put_pixel(dst, x, y, get_pixel(src, (int)src_x, (int)src_y));
+                if (bitmap_get(src, (int)src_x, (int)src_y)) bitmap_set(dst, x, y);
             }
         }
     }
-    if (SDL_MUSTLOCK(src)) SDL_UnlockSurface(src);
-    if (SDL_MUSTLOCK(dst)) SDL_UnlockSurface(dst);
-    return dst;
-}
-
-// --- NOUVELLE LOGIQUE : Smearing (Dilatation) ---
-
-// Applique une "bavure" horizontale et verticale sur une copie de travail
-// Cela permet de connecter les lettres entre elles pour former un gros bloc,
-// sans abîmer l'image originale.
-static SDL_Surface* create_smeared_map(SDL_Surface* src, int radius_x, int radius_y) {
-    SDL_Surface* temp = SDL_CreateRGBSurfaceWithFormat(0, src->w, src->h, 32, SDL_PIXELFORMAT_ARGB8888);
-    SDL_FillRect(temp, NULL, 0xFFFFFFFF);
-    
-    if (SDL_MUSTLOCK(src)) SDL_LockSurface(src);
-    if (SDL_MUSTLOCK(temp)) SDL_LockSurface(temp);
-
-    uint32_t black = SDL_MapRGB(temp->format, 0, 0, 0);
-
-    // 1. Smear Horizontal
-    for (int y = 0; y < src->h; y++) {
-        int run = 0;
-        for (int x = 0; x < src->w; x++) {
-            if (is_black(get_pixel(src, x, y))) {
-                run = radius_x; // On recharge le "crayon"
-            }
-            if (run > 0) {
-                put_pixel(temp, x, y, black);
-                run--;
-            }
-        }
-        // Scan inverse (droite vers gauche) pour boucher les trous
-        run = 0;
-        for (int x = src->w - 1; x >= 0; x--) {
-            if (is_black(get_pixel(src, x, y))) run = radius_x;
-            if (run > 0) { put_pixel(temp, x, y, black); run--; }
-        }
-    }
-
-    // 2. Smear Vertical (sur le résultat horizontal)
-    // On fait une copie temporaire pour ne pas lire ce qu'on vient d'écrire
-    SDL_Surface* res = SDL_CreateRGBSurfaceWithFormat(0, src->w, src->h, 32, SDL_PIXELFORMAT_ARGB8888);
-    SDL_FillRect(res, NULL, 0xFFFFFFFF);
-    if (SDL_MUSTLOCK(res)) SDL_LockSurface(res);
-
-    for (int x = 0; x < src->w; x++) {
-        int run = 0;
-        for (int y = 0; y < src->h; y++) {
-            if (is_black(get_pixel(temp, x, y))) run = radius_y;
-            if (run > 0) { put_pixel(res, x, y, black); run--; }
-        }
-        run = 0;
-        for (int y = src->h - 1; y >= 0; y--) {
-            if (is_black(get_pixel(temp, x, y))) run = radius_y;
-            if (run > 0) { put_pixel(res, x, y, black); run--; }
-        }
-    }
-
-    if (SDL_MUSTLOCK(src)) SDL_UnlockSurface(src);
-    if (SDL_MUSTLOCK(temp)) SDL_UnlockSurface(temp);
-    if (SDL_MUSTLOCK(res)) SDL_UnlockSurface(res);
-    
-    SDL_FreeSurface(temp);
-    return res;
+    return 0;
 }
 
-// Analyse le profil d'une image "smeared" pour trouver le plus grand bloc
-static void find_largest_block_range(int* prof, int N, int* start, int* end) {
-    int max_len = 0;
-    int cur_len = 0;
-    int cur_start = -1;
-    int best_start = 0;
-    int best_end = N;
-
-    // Seuil de détection: sur l'image smeared, c'est presque tout noir (haute densité)
-    // Mais on prend > 0 pour attraper tout le bloc.
-    for (int i = 0; i < N; i++) {
-        if (prof[i] > 0) {
-            if (cur_start == -1) cur_start = i;
-            cur_len++;
-        } else {
-            if (cur_start != -1) {
-                // Fin d'un bloc
-                if (cur_len > max_len) {
-                    max_len = cur_len;
-                    best_start = cur_start;
-                    best_end = i;
-                }
-                cur_start = -1;
-                cur_len = 0;
-            }
+// --- Localisation de la grille : composantes de la page "smeared" ---
+
+// Parmi les composantes de la page bavée, celle de la grille. La bavure soude
+// les lettres et le cadre en un gros bloc plein ; les mots de la liste, à côté,
+// forment un bloc à part, plus petit. On garde donc la plus grande surface,
+// pondérée par le remplissage (surface / boîte englobante) pour ne pas préférer
+// une illustration ou un cadre décoratif à peine encré mais très étendu.
+static int pick_grid_component(const Components* cc) {
+    int best = -1;
+    double best_score = 0.0;
+    for (int i = 0; i < cc->count; i++) {
+        const Component* c = &cc->items[i];
+        double box = (double)(c->x1 - c->x0) * (c->y1 - c->y0);
+        double fill = c->area / box;
+        double score = c->area * fill;
+        if (score > best_score) {
+            best_score = score;
+            best = i;
         }
     }
-    // Check fin de tableau
-    if (cur_start != -1 && cur_len > max_len) {
-        max_len = cur_len;
-        best_start = cur_start;
-        best_end = N;
-    }
-
-    *start = best_start;
-    *end = best_end;
+    return best;
 }
 
-
-SDL_Surface* extract_grid(SDL_Surface* bin, int* out_x, int* out_y, int* out_w, int* out_h) {
-    if (!bin) return NULL;
-
+// La grille est copiée dans grid, pris dans scratch après la page redressée
+// dont elle est découpée ; les tampons de travail sont rendus au fur et à mesure
+static int locate_grid(const Bitmap* page, Bitmap* grid, int* out_x, int* out_y, int* out_w, int* out_h,
+                       ThreadPool* pool, Arena* scratch) {
     // 1. Rotation
-    double angle = detect_skew_angle(bin);
-    SDL_Surface* work;
-    if (fabs(angle) > 0.5) work = rotate_surface(bin, angle);
-    else {
-        work = SDL_CreateRGBSurfaceWithFormat(0, bin->w, bin->h, 32, SDL_PIXELFORMAT_ARGB8888);
-        SDL_BlitSurface(bin, NULL, work, NULL);
+    double confidence;
+    ArenaMark mark = arena_mark(scratch);
+    double angle = detect_skew_angle(page, &confidence, pool, scratch);
+    arena_release(scratch, mark);
+    printf("[extract_grid] Detected Skew: %.2f degrees (confidence %.2f)\n", angle, confidence);
+    Bitmap rotated = { NULL, 0, 0, 0, NULL };
+    const Bitmap* work = page;
+    if (fabs(angle) > 0.5) {
+        if (rotate_bitmap(page, angle, &rotated, scratch) != 0) return -1;
+        work = &rotated;
     }
+    mark = arena_mark(scratch);
 
     // 2. Création de la "Smeared Map"
     // On dilate fortement (ex: 20px) pour relier les lettres et le cadre
@@ -241,47 +171,38 @@ SDL_Surface* extract_grid(SDL_Surface* bin, int* out_x, int* out_y, int* out_w,
     printf("[extract_grid] Generating smeared map for detection...\n");
     int smear_radius = (work->w / 50); // environ 2% de la largeur
     if (smear_radius < 5) smear_radius = 5;
-    
-    SDL_Surface* smeared = create_smeared_map(work, smear_radius, smear_radius);
-    
-    // Décommenter pour debug : 
-    // SDL_SaveBMP(smeared, "debug_smeared.bmp");
 
-    // 3. Projection Verticale (X) sur la map smeared
-    int* Vprof = (int*)calloc(work->w, sizeof(int));
-    if (SDL_MUSTLOCK(smeared)) SDL_LockSurface(smeared);
-    
-    for (int x = 0; x < smeared->w; x++) {
-        for (int y = 0; y < smeared->h; y++) {
-            if (is_black(get_pixel(smeared, x, y))) Vprof[x]++;
-        }
+    Bitmap smeared;
+    if (bitmap_dilate(work, smear_radius - 1, smear_radius - 1, &smeared, scratch) != 0) {
+        bitmap_free(&rotated);
+        return -1;
     }
 
-    // Trouver la zone X la plus large (la grille est généralement le plus gros objet)
-    int gx0, gx1;
-    find_largest_block_range(Vprof, smeared->w, &gx0, &gx1);
-    free(Vprof);
-    
-    printf("[extract_grid] Found X range: %d -> %d\n", gx0, gx1);
-
-    // 4. Projection Horizontale (Y) MAIS restreinte à la zone X trouvée
-    int* Hprof = (int*)calloc(work->h, sizeof(int));
-    for (int y = 0; y < smeared->h; y++) {
-        // On ne regarde que dans la colonne identifiée
-        for (int x = gx0; x < gx1; x++) {
-            if (is_black(get_pixel(smeared, x, y))) Hprof[y]++;
-        }
+    // 3. Composantes connexes de la map smeared, en un seul passage
+    Components cc;
+    int found = components_find(&smeared, &cc, scratch);
+    bitmap_free(&smeared); // On n'a plus besoin de la map moche
+    if (found != 0) {
+        bitmap_free(&rotated);
+        return -1;
     }
-    if (SDL_MUSTLOCK(smeared)) SDL_UnlockSurface(smeared);
 
-    // Trouver la zone Y la plus haute dans cette colonne
-    int gy0, gy1;
-    find_largest_block_range(Hprof, smeared->h, &gy0, &gy1);
-    free(Hprof);
-
-    printf("[extract_grid] Found Y range: %d -> %d\n", gy0, gy1);
-
-    SDL_FreeSurface(smeared); // On n'a plus besoin de la map moche
+    // 4. Le bloc de la grille
+    int best = pick_grid_component(&cc);
+    if (best < 0) {
+        fprintf(stderr, "[extract_grid] ✗ Failed to detect valid grid block.\n");
+        components_free(&cc);
+        bitmap_free(&rotated);
+        return -1;
+    }
+    const Component* block = &cc.items[best];
+    int gx0 = block->x0, gx1 = block->x1;
+    int gy0 = block->y0, gy1 = block->y1;
+    printf("[extract_grid] Found block: (%d,%d) -> (%d,%d), fill %.2f, %d components\n",
+           gx0, gy0, gx1, gy1,
+           block->area / ((double)(gx1 - gx0) * (gy1 - gy0)), cc.count);
+    components_free(&cc);
+    arena_release(scratch, mark);
 
     // 5. Raffinement et Crop
     // On a maintenant les coordonnées brutes du "plus gros bloc"
@@ -301,21 +222,49 @@ SDL_Surface* extract_grid(SDL_Surface* bin, int* out_x, int* out_y, int* out_w,
 
     if (w < 50 || h < 50) {
         fprintf(stderr, "[extract_grid] ✗ Failed to detect valid grid block.\n");
-        SDL_FreeSurface(work);
-        return NULL;
+        bitmap_free(&rotated);
+        return -1;
     }
 
-    SDL_Rect src_rect = { gx0, gy0, w, h };
-    SDL_Surface* grid = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
-    SDL_FillRect(grid, NULL, 0xFFFFFFFF);
-    SDL_BlitSurface(work, &src_rect, grid, NULL);
+    if (bitmap_init_in(grid, w, h, scratch) != 0) {
+        bitmap_free(&rotated);
+        return -1;
+    }
+    bitmap_copy_region(work, gx0, gy0, w, h, grid, 0, 0);
+    bitmap_free(&rotated);
 
     if (out_x) *out_x = gx0;
     if (out_y) *out_y = gy0;
     if (out_w) *out_w = w;
     if (out_h) *out_h = h;
 
-    SDL_FreeSurface(work);
     printf("[extract_grid] ✓ Grid extracted successfully (%dx%d)\n", w, h);
-    return grid;
+    return 0;
+}
+
+int extract_grid_bitmap(const Bitmap* page, Bitmap* grid, int* out_x, int* out_y, int* out_w, int* out_h,
+                        ThreadPool* pool, Arena* scratch) {
+    if (!page || !grid) return -1;
+
+    // En cas d'échec, tout ce que l'étape a pris dans scratch lui est rendu
+    ArenaMark mark = arena_mark(scratch);
+    int res = locate_grid(page, grid, out_x, out_y, out_w, out_h, pool, scratch);
+    if (res != 0) arena_release(scratch, mark);
+    return res;
+}
+
+SDL_Surface* extract_grid(SDL_Surface* bin, int* out_x, int* out_y, int* out_w, int* out_h,
+                          ThreadPool* pool) {
+    if (!bin) return NULL;
+
+    Bitmap page;
+    if (bitmap_from_surface(&page, bin) != 0) return NULL;
+    Bitmap grid;
+    SDL_Surface* res = NULL;
+    if (extract_grid_bitmap(&page, &grid, out_x, out_y, out_w, out_h, pool, NULL) == 0) {
+        res = bitmap_to_surface(&grid, 0, 0, grid.w, grid.h);
+        bitmap_free(&grid);
+    }
+    bitmap_free(&page);
+    return res;
 }
@@ -1,5 +1,23 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include "bitmap.h"
+#include "../utils/thread_pool.h"
 
 
-SDL_Surface* extract_grid(SDL_Surface* bin, int* out_x, int* out_y, int* out_w, int* out_h);
+// pool: threads for the line votes (NULL = current thread)
+SDL_Surface* extract_grid(SDL_Surface* bin, int* out_x, int* out_y, int* out_w, int* out_h,
+                          ThreadPool* pool);
+
+// Same on the ink plane of the page (not modified): the grid is copied into
+// grid. Returns 0, or -1. The work buffers come from scratch (NULL = heap) and
+// are given back, but grid is taken from it too, after the deskewed page it is
+// cut from: both stay until the caller releases them (with NULL, bitmap_free
+// the grid).
+int extract_grid_bitmap(const Bitmap* page, Bitmap* grid, int* out_x, int* out_y, int* out_w, int* out_h,
+                        ThreadPool* pool, Arena* scratch);
+
+// Skew of the page in degrees, within +-5: the angle whose Hough votes (see
+// hough.h) are sharpest, for the near horizontal and near vertical lines
+// together. confidence (may be NULL): 0 = no preferred angle, near 1 = sharp peak.
+// The votes are taken from scratch and not given back (NULL = heap, freed).
+double detect_skew_angle(const Bitmap* page, double* confidence, ThreadPool* pool, Arena* scratch);
@@ -1,73 +1,48 @@
 #include "extract_wordlist.h"
+#include "bitmap.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdbool.h>
 
-static inline bool is_black(uint32_t px) {
-    return ((px & 0x00FFFFFF) == 0);
-}
-
-static int count_black_in_region(SDL_Surface* s, int x0, int y0, int w, int h) {
-    if (x0 < 0 || y0 < 0 || w <= 0 || h <= 0) return 0;
-    if (x0 + w > s->w || y0 + h > s->h) return 0;
-    
-    uint8_t* base = (uint8_t*)s->pixels;
-    int pitch = s->pitch;
-    int cnt = 0;
-    
-    for (int y = y0; y < y0 + h; y++) {
-        uint32_t* row = (uint32_t*)(base + y * pitch);
-        for (int x = x0; x < x0 + w; x++) {
-            if (is_black(row[x])) cnt++;
-        }
-    }
-    return cnt;
-}
-
-SDL_Surface* extract_wordlist(SDL_Surface* bin, int grid_x, int grid_y, int grid_w, int grid_h,
-                               int* out_x, int* out_y, int* out_w, int* out_h) {
-    if (!bin) return NULL;
-
-    if (SDL_MUSTLOCK(bin)) SDL_LockSurface(bin);
+int extract_wordlist_bitmap(const Bitmap* page, int grid_x, int grid_y, int grid_w, int grid_h,
+                            Bitmap* wl, int* out_x, int* out_y, int* out_w, int* out_h, Arena* scratch) {
+    if (!page || !wl) return -1;
 
     const int padding = 10; // Safety margin around grid
 
     // LEFT MARGIN
     int left_w = (grid_x > padding) ? grid_x - padding : 0;
-    int left_h = bin->h;
+    int left_h = page->h;
     int left_cnt = 0;
     if (left_w > 0) {
-        left_cnt = count_black_in_region(bin, 0, 0, left_w, left_h);
+        left_cnt = (int)bitmap_count_region(page, 0, 0, left_w, left_h);
     }
 
     // RIGHT MARGIN
     int right_x = grid_x + grid_w + padding;
-    int right_w = (right_x < bin->w) ? bin->w - right_x : 0;
-    int right_h = bin->h;
+    int right_w = (right_x < page->w) ? page->w - right_x : 0;
+    int right_h = page->h;
     int right_cnt = 0;
     if (right_w > 0) {
-        right_cnt = count_black_in_region(bin, right_x, 0, right_w, right_h);
+        right_cnt = (int)bitmap_count_region(page, right_x, 0, right_w, right_h);
     }
 
     // TOP MARGIN
-    int top_w = bin->w;
+    int top_w = page->w;
     int top_h = (grid_y > padding) ? grid_y - padding : 0;
     int top_cnt = 0;
     if (top_h > 0) {
-        top_cnt = count_black_in_region(bin, 0, 0, top_w, top_h);
+        top_cnt = (int)bitmap_count_region(page, 0, 0, top_w, top_h);
     }
 
     // BOTTOM MARGIN
     int bottom_y = grid_y + grid_h + padding;
-    int bottom_w = bin->w;
-    int bottom_h = (bottom_y < bin->h) ? bin->h - bottom_y : 0;
+    int bottom_w = page->w;
+    int bottom_h = (bottom_y < page->h) ? page->h - bottom_y : 0;
     int bottom_cnt = 0;
     if (bottom_h > 0) {
-        bottom_cnt = count_black_in_region(bin, 0, bottom_y, bottom_w, bottom_h);
+        bottom_cnt = (int)bitmap_count_region(page, 0, bottom_y, bottom_w, bottom_h);
     }
 
-    if (SDL_MUSTLOCK(bin)) SDL_UnlockSurface(bin);
-
     // ============================
     // Choose margin with most ink
     // ============================
@@ -102,7 +77,7 @@ SDL_Surface* extract_wordlist(SDL_Surface* bin, int grid_x, int grid_y, int grid
 
     if (max_cnt == 0 || wl_w <= 0 || wl_h <= 0) {
         fprintf(stderr, "[extract_wordlist] ERROR: no suitable word list margin found\n");
-        return NULL;
+        return -1;
     }
 
     printf("  → Selected: %s margin (%d pixels of ink)\n", position, max_cnt);
@@ -111,24 +86,36 @@ SDL_Surface* extract_wordlist(SDL_Surface* bin, int grid_x, int grid_y, int grid
     // Crop the selected region
     // ============================
 
-    SDL_Rect src_rect = { wl_x, wl_y, wl_w, wl_h };
-    SDL_Surface* wl = SDL_CreateRGBSurfaceWithFormat(0, wl_w, wl_h, 32, SDL_PIXELFORMAT_ARGB8888);
-    if (!wl) {
-        fprintf(stderr, "[extract_wordlist] ERROR: surface creation failed: %s\n", SDL_GetError());
-        return NULL;
-    }
-    
-    SDL_Rect dst_rect = { 0, 0, 0, 0 };
-    if (SDL_BlitSurface(bin, &src_rect, wl, &dst_rect) != 0) {
-        fprintf(stderr, "[extract_wordlist] ERROR: blit failed: %s\n", SDL_GetError());
-        SDL_FreeSurface(wl);
-        return NULL;
+    if (bitmap_init_in(wl, wl_w, wl_h, scratch) != 0) {
+        fprintf(stderr, "[extract_wordlist] ERROR: out of memory\n");
+        return -1;
     }
+    bitmap_copy_region(page, wl_x, wl_y, wl_w, wl_h, wl, 0, 0);
 
     if (out_x) *out_x = wl_x;
     if (out_y) *out_y = wl_y;
     if (out_w) *out_w = wl_w;
     if (out_h) *out_h = wl_h;
 
-    return wl;
+    return 0;
+}
+
+SDL_Surface* extract_wordlist(SDL_Surface* bin, int grid_x, int grid_y, int grid_w, int grid_h,
+                               int* out_x, int* out_y, int* out_w, int* out_h) {
+    if (!bin) return NULL;
+
+    Bitmap page;
+    if (bitmap_from_surface(&page, bin) != 0) {
+        fprintf(stderr, "[extract_wordlist] ERROR: out of memory\n");
+        return NULL;
+    }
+    Bitmap wl;
+    SDL_Surface* res = NULL;
+    if (extract_wordlist_bitmap(&page, grid_x, grid_y, grid_w, grid_h, &wl,
+                                out_x, out_y, out_w, out_h, NULL) == 0) {
+        res = bitmap_to_surface(&wl, 0, 0, wl.w, wl.h);
+        bitmap_free(&wl);
+    }
+    bitmap_free(&page);
+    return res;
 }
@@ -1,5 +1,10 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include "bitmap.h"
 
 
-SDL_Surface* extract_wordlist(SDL_Surface* bin, int grid_x, int grid_y, int grid_w, int grid_h, int* out_x, int* out_y, int* out_w, int* out_h);
\ No newline at end of file
+SDL_Surface* extract_wordlist(SDL_Surface* bin, int grid_x, int grid_y, int grid_w, int grid_h, int* out_x, int* out_y, int* out_w, int* out_h);
+
+// Same on the ink plane of the page (not modified): the word list is copied
+// into wl, taken from scratch (NULL = heap, bitmap_free it). Returns 0, or -1.
+int extract_wordlist_bitmap(const Bitmap* page, int grid_x, int grid_y, int grid_w, int grid_h, Bitmap* wl, int* out_x, int* out_y, int* out_w, int* out_h, Arena* scratch);
\ No newline at end of file
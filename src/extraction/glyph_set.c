@@ -0,0 +1,124 @@
+#include "glyph_set.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+void glyph_set_init(GlyphSet* set) {
+    set->items = NULL;
+    set->count = 0;
+    set->capacity = 0;
+    set->rows = 0;
+    set->cols = 0;
+    memset(&set->source, 0, sizeof(set->source));
+}
+
+void glyph_set_free(GlyphSet* set) {
+    free(set->items);
+    bitmap_free(&set->source);
+    glyph_set_init(set);
+}
+
+int glyph_set_load(GlyphSet* set, const Bitmap* bm) {
+    bitmap_free(&set->source);
+    if (bitmap_init(&set->source, bm->w, bm->h) != 0) return -1;
+    memcpy(set->source.bits, bm->bits, sizeof(uint64_t) * (size_t)bm->words * bm->h);
+    return 0;
+}
+
+int glyph_set_load_from(GlyphSet* set, const GlyphSet* src) {
+    return glyph_set_load(set, &src->source);
+}
+
+int glyph_set_push(GlyphSet* set, SDL_Rect rect, SDL_Rect clip, int fill, int row, int col) {
+    if (set->count == set->capacity) {
+        int capacity = set->capacity ? set->capacity * 2 : 64;
+        Glyph* items = (Glyph*)realloc(set->items, capacity * sizeof(Glyph));
+        if (!items) return -1;
+        set->items = items;
+        set->capacity = capacity;
+    }
+
+    Glyph* g = &set->items[set->count++];
+    g->rect = rect;
+    g->clip = clip;
+    g->fill = fill;
+    g->row = row;
+    g->col = col;
+    return 0;
+}
+
+// Part of g read from the bitmap (empty if w or h <= 0)
+static SDL_Rect read_area(const Glyph* g) {
+    SDL_Rect a;
+    if (!SDL_IntersectRect(&g->rect, &g->clip, &a)) a.w = a.h = 0;
+    return a;
+}
+
+int glyph_ink_bounds(const GlyphSet* set, const Glyph* g, int* left, int* top, int* right, int* bottom) {
+    SDL_Rect a = read_area(g);
+    return bitmap_ink_bounds(&set->source, a.x, a.y, a.w, a.h, left, top, right, bottom);
+}
+
+float glyph_gray(const void* view, int x, int y) {
+    const GlyphView* v = (const GlyphView*)view;
+    const Bitmap* bm = &v->set->source;
+    SDL_Point p = { x, y };
+    if (!SDL_PointInRect(&p, &v->glyph->clip)) return v->glyph->fill ? 0.0f : 1.0f;
+    if (x < 0 || y < 0 || x >= bm->w || y >= bm->h) return 1.0f;
+    return bitmap_get(bm, x, y) ? 0.0f : 1.0f;
+}
+
+SDL_Surface* glyph_to_surface(const GlyphSet* set, const Glyph* g) {
+    if (g->rect.w <= 0 || g->rect.h <= 0) return NULL;
+    SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, g->rect.w, g->rect.h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!s) return NULL;
+
+    // the black of a trimmed cell margin has always been 0 (alpha included)
+    SDL_FillRect(s, NULL, g->fill ? 0 : 0xFFFFFFFF);
+    SDL_Rect a = read_area(g);
+    if (a.w > 0 && a.h > 0)
+        bitmap_blit(&set->source, a.x, a.y, a.w, a.h, s, a.x - g->rect.x, a.y - g->rect.y);
+    return s;
+}
+
+int glyph_to_bitmap(const GlyphSet* set, const Glyph* g, Bitmap* bm, Arena* arena) {
+    if (bitmap_init_in(bm, g->rect.w, g->rect.h, arena) != 0) return -1;
+
+    SDL_Rect a = read_area(g);
+    if (a.w > 0 && a.h > 0)
+        bitmap_copy_region(&set->source, a.x, a.y, a.w, a.h, bm, a.x - g->rect.x, a.y - g->rect.y);
+    if (g->fill) {
+        for (int y = 0; y < bm->h; y++) {
+            for (int x = 0; x < bm->w; x++) {
+                SDL_Point p = { g->rect.x + x, g->rect.y + y };
+                if (!SDL_PointInRect(&p, &g->clip)) bitmap_set(bm, x, y);
+            }
+        }
+    }
+    return 0;
+}
+
+int glyph_set_save(const GlyphSet* set, const char* dir, const char* name_fmt, long* bytes) {
+    mkdir(dir, 0755);
+
+    char name[256];
+    char path[512];
+    int saved = 0;
+    for (int i = 0; i < set->count; i++) {
+        const Glyph* g = &set->items[i];
+        SDL_Surface* s = glyph_to_surface(set, g);
+        if (!s) continue;
+
+        snprintf(name, sizeof(name), name_fmt, g->row, g->col);
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        int ret = SDL_SaveBMP(s, path);
+        SDL_FreeSurface(s);
+        if (ret != 0) continue;
+        saved++;
+
+        struct stat st;
+        if (bytes && stat(path, &st) == 0) *bytes += st.st_size;
+    }
+    return saved;
+}
@@ -0,0 +1,68 @@
+#ifndef GLYPH_SET_H
+#define GLYPH_SET_H
+
+#include <SDL2/SDL.h>
+#include "bitmap.h"
+#include "../utils/arena.h"
+
+// One sliced image (grid cell, word, or letter of a word): a rectangle of the
+// bitmap of its set, not a copy. Pixels of rect inside clip are read from the
+// bitmap (white past its edges); the others are fill.
+typedef struct {
+    SDL_Rect rect;
+    SDL_Rect clip;
+    int fill;   // 1: ink (black) outside clip, 0: white
+    int row;    // grid row, or word index
+    int col;    // grid column, or letter index in the word
+} Glyph;
+
+// Images produced by a slicing stage, in (row, col) order, all cut from one
+// bitmap the set owns. Slicers fill it, trimmers shrink the rectangles in
+// place and the OCR reads it directly: no image is copied until the OCR
+// scales it to its input size, and nothing goes through BMP files on disk.
+typedef struct {
+    Glyph* items;
+    int count;
+    int capacity;
+    int rows;   // grid rows, or number of words
+    int cols;   // grid columns (0 for words and letters)
+    Bitmap source;
+} GlyphSet;
+
+void glyph_set_init(GlyphSet* set);
+void glyph_set_free(GlyphSet* set);
+
+// Copies bm as the bitmap of the set, replacing the previous one (a copy of
+// the packed words, so bm may live in a scratch arena). Returns 0, or -1 on
+// error.
+int glyph_set_load(GlyphSet* set, const Bitmap* bm);
+// Same with the bitmap of src
+int glyph_set_load_from(GlyphSet* set, const GlyphSet* src);
+
+// Appends a glyph; returns 0, or -1 if out of memory
+int glyph_set_push(GlyphSet* set, SDL_Rect rect, SDL_Rect clip, int fill, int row, int col);
+
+// Bounding box of the ink of g read from the bitmap (within rect and clip), in
+// bitmap coordinates, right and bottom exclusive. Returns 0 (and leaves the
+// outputs alone) if there is none, 1 otherwise.
+int glyph_ink_bounds(const GlyphSet* set, const Glyph* g, int* left, int* top, int* right, int* bottom);
+
+// A glyph with its set, read in place by the OCR: glyph_gray is the pixel
+// callback of glyph_from_rect (0 ink, 1 white), in bitmap coordinates
+typedef struct {
+    const GlyphSet* set;
+    const Glyph* glyph;
+} GlyphView;
+
+float glyph_gray(const void* view, int x, int y);
+
+// Copies of g, for the stages that need the pixels themselves: an ARGB8888
+// surface (NULL on error), or a bitmap taken from arena (0, or -1 on error)
+SDL_Surface* glyph_to_surface(const GlyphSet* set, const Glyph* g);
+int glyph_to_bitmap(const GlyphSet* set, const Glyph* g, Bitmap* bm, Arena* arena);
+
+// Debug dump: saves every image as dir/<name_fmt formatted with row, col>.
+// Returns the number of files saved; adds their total size to *bytes if not NULL
+int glyph_set_save(const GlyphSet* set, const char* dir, const char* name_fmt, long* bytes);
+
+#endif
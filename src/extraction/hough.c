@@ -0,0 +1,235 @@
+#include "hough.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Angles voted together: their increments go to different rows, so the points
+// of one line (which hit the same bin one after another) do not wait on each
+// other's store
+#define HOUGH_GROUP 4
+
+// Columns of row y kept out of every 64: keep (one bit every stride) rotated
+static inline uint64_t row_pattern(uint64_t keep, int stride, int y) {
+    int r = (int)(((uint32_t)y * 0x9E3779B1u) >> 16) & (stride - 1);
+    return r ? keep << r | keep >> (64 - r) : keep;
+}
+
+int hough_points_init(HoughPoints* pts, const Bitmap* bm, int max_points, Arena* arena) {
+    memset(pts, 0, sizeof(*pts));
+    pts->arena = arena;
+    pts->w = bm->w;
+    pts->h = bm->h;
+
+    long ink = bitmap_count_region(bm, 0, 0, bm->w, bm->h);
+    int stride = 1;
+    while (max_points > 0 && stride < 64 && ink / stride > max_points) stride *= 2;
+    uint64_t keep = ~(uint64_t)0;
+    if (stride > 1) {
+        keep = 0;
+        for (int i = 0; i < 64; i += stride) keep |= (uint64_t)1 << i;
+    }
+
+    // The kept columns move by a scrambled amount from row to row: each row
+    // and each column gets its share of points, along no preferred direction.
+    // Dense columns can then keep more than ink / stride points, so they are
+    // counted exactly first.
+    long count = 0;
+    for (int y = 0; y < bm->h; y++) {
+        const uint64_t* row = bitmap_row(bm, y);
+        uint64_t shifted = row_pattern(keep, stride, y);
+        for (int k = 0; k < bm->words; k++) count += __builtin_popcountll(row[k] & shifted);
+    }
+
+    long cap = (count + HOUGH_CHUNK - 1) / HOUGH_CHUNK * HOUGH_CHUNK;
+    pts->xs = (float*)arena_calloc(arena, cap > 0 ? cap : 1, sizeof(float));
+    pts->ys = (float*)arena_calloc(arena, cap > 0 ? cap : 1, sizeof(float));
+    if (!pts->xs || !pts->ys) {
+        hough_points_free(pts);
+        return -1;
+    }
+
+    int cx = bm->w / 2, cy = bm->h / 2;
+    for (int y = 0; y < bm->h; y++) {
+        const uint64_t* row = bitmap_row(bm, y);
+        uint64_t shifted = row_pattern(keep, stride, y);
+        for (int k = 0; k < bm->words; k++) {
+            uint64_t v = row[k] & shifted;
+            while (v) {
+                pts->xs[pts->count] = (float)(k * 64 + __builtin_ctzll(v) - cx);
+                pts->ys[pts->count] = (float)(y - cy);
+                pts->count++;
+                v &= v - 1;
+            }
+        }
+    }
+    return 0;
+}
+
+void hough_points_free(HoughPoints* pts) {
+    arena_dealloc(pts->arena, pts->xs);
+    arena_dealloc(pts->arena, pts->ys);
+    pts->xs = pts->ys = NULL;
+    pts->count = 0;
+}
+
+int hough_init(HoughSpace* hs, const HoughPoints* pts, const double* theta_deg, int n, Arena* arena) {
+    memset(hs, 0, sizeof(*hs));
+    hs->arena = arena;
+
+    // |rho| never exceeds the half diagonal; one spare bin on each side
+    // absorbs the float rounding
+    double half_diag = sqrt((double)pts->w * pts->w + (double)pts->h * pts->h) / 2.0;
+    hs->thetas = n;
+    hs->offset = (int)ceil(half_diag) + 1;
+    hs->rhos = 2 * hs->offset + 1;
+    hs->theta = (double*)arena_alloc(arena, sizeof(double) * (n > 0 ? n : 1));
+    hs->cos_t = (float*)arena_alloc(arena, sizeof(float) * (n > 0 ? n : 1));
+    hs->sin_t = (float*)arena_alloc(arena, sizeof(float) * (n > 0 ? n : 1));
+    hs->votes = (int*)arena_calloc(arena, (size_t)hs->rhos * (n > 0 ? n : 1), sizeof(int));
+    if (!hs->theta || !hs->cos_t || !hs->sin_t || !hs->votes) {
+        hough_free(hs);
+        return -1;
+    }
+
+    for (int t = 0; t < n; t++) {
+        double rad = theta_deg[t] * M_PI / 180.0;
+        hs->theta[t] = theta_deg[t];
+        hs->cos_t[t] = (float)cos(rad);
+        hs->sin_t[t] = (float)sin(rad);
+    }
+    return 0;
+}
+
+void hough_free(HoughSpace* hs) {
+    arena_dealloc(hs->arena, hs->theta);
+    arena_dealloc(hs->arena, hs->cos_t);
+    arena_dealloc(hs->arena, hs->sin_t);
+    arena_dealloc(hs->arena, hs->votes);
+    memset(hs, 0, sizeof(*hs));
+}
+
+// Votes of the points [first, last) (whole chunks) into acc
+static void vote_points(const HoughSpace* hs, const HoughPoints* pts, int first, int last, int* acc) {
+    int idx[HOUGH_GROUP][HOUGH_CHUNK];
+    float off = (float)hs->offset;
+    int rhos = hs->rhos;
+
+    for (int base = first; base < last; base += HOUGH_CHUNK) {
+        int n = last - base < HOUGH_CHUNK ? last - base : HOUGH_CHUNK;
+        const float* xs = pts->xs + base;
+        const float* ys = pts->ys + base;
+
+        for (int t0 = 0; t0 < hs->thetas; t0 += HOUGH_GROUP) {
+            int g = hs->thetas - t0 < HOUGH_GROUP ? hs->thetas - t0 : HOUGH_GROUP;
+            // Always a whole chunk (the last one is padded with zeros): a fixed
+            // length loop without dependencies, vectorized by the compiler
+            for (int j = 0; j < g; j++) {
+                float cs = hs->cos_t[t0 + j], sn = hs->sin_t[t0 + j];
+                for (int i = 0; i < HOUGH_CHUNK; i++) idx[j][i] = (int)(xs[i] * cs + ys[i] * sn + off);
+            }
+
+            int* row = acc + (size_t)t0 * rhos;
+            if (g == HOUGH_GROUP) {
+                for (int i = 0; i < n; i++) {
+                    row[idx[0][i]]++;
+                    row[rhos + idx[1][i]]++;
+                    row[2 * rhos + idx[2][i]]++;
+                    row[3 * rhos + idx[3][i]]++;
+                }
+            } else {
+                for (int j = 0; j < g; j++)
+                    for (int i = 0; i < n; i++) row[j * rhos + idx[j][i]]++;
+            }
+        }
+    }
+}
+
+typedef struct {
+    const HoughSpace* hs;
+    const HoughPoints* pts;
+    int tasks;
+    int chunks;
+    int* acc;       // one accumulator per task but the first, which votes in hs
+} VoteJob;
+
+static void vote_task(void* arg, int task) {
+    VoteJob* job = (VoteJob*)arg;
+    int first = (int)((long)job->chunks * task / job->tasks) * HOUGH_CHUNK;
+    int last = (int)((long)job->chunks * (task + 1) / job->tasks) * HOUGH_CHUNK;
+    if (last > job->pts->count) last = job->pts->count;
+
+    size_t size = (size_t)job->hs->thetas * job->hs->rhos;
+    int* acc = task == 0 ? job->hs->votes : job->acc + (task - 1) * size;
+    vote_points(job->hs, job->pts, first, last, acc);
+}
+
+int hough_vote(HoughSpace* hs, const HoughPoints* pts, ThreadPool* pool) {
+    VoteJob job;
+    job.hs = hs;
+    job.pts = pts;
+    job.chunks = (pts->count + HOUGH_CHUNK - 1) / HOUGH_CHUNK;
+    job.tasks = pool ? thread_pool_size(pool) : 1;
+    if (job.tasks > job.chunks) job.tasks = job.chunks;
+    if (job.tasks < 1) return 0;
+
+    size_t size = (size_t)hs->thetas * hs->rhos;
+    job.acc = NULL;
+    if (job.tasks > 1) {
+        job.acc = (int*)arena_calloc(hs->arena, size * (job.tasks - 1), sizeof(int));
+        if (!job.acc) return -1;
+    }
+
+    thread_pool_run(job.tasks > 1 ? pool : NULL, job.tasks, vote_task, &job);
+
+    for (int k = 0; k < job.tasks - 1; k++) {
+        const int* acc = job.acc + k * size;
+        for (size_t i = 0; i < size; i++) hs->votes[i] += acc[i];
+    }
+    arena_dealloc(hs->arena, job.acc);
+    return 0;
+}
+
+double hough_sharpness(const HoughSpace* hs, int t) {
+    const int* row = hough_row(hs, t);
+    double score = 0.0;
+    for (int b = 0; b < hs->rhos; b++) score += (double)row[b] * row[b];
+    return score;
+}
+
+int hough_sharpest(const HoughSpace* hs, int t0, int t1) {
+    int best_t = t0;
+    double best = -1.0;
+    for (int t = t0; t < t1; t++) {
+        double v = hough_sharpness(hs, t);
+        if (v > best) { best = v; best_t = t; }
+    }
+    return best_t;
+}
+
+int* hough_peaks(const HoughSpace* hs, int t, int min_votes, int* count) {
+    const int* row = hough_row(hs, t);
+    int N = hs->rhos;
+    // a run ends on a bin under min_votes, so there are at most N / 2 + 1 of them
+    int* lines = (int*)arena_alloc(hs->arena, sizeof(int) * (N / 2 + 1));
+    *count = 0;
+    if (!lines) return NULL;
+
+    int in_run = 0, run_start = 0;
+    for (int i = 0; i < N; i++) {
+        if (row[i] >= min_votes) {
+            if (!in_run) {
+                run_start = i;
+                in_run = 1;
+            }
+        } else if (in_run) {
+            lines[(*count)++] = (run_start + i - 1) / 2 - hs->offset;
+            in_run = 0;
+        }
+    }
+    if (in_run) lines[(*count)++] = (run_start + N - 1) / 2 - hs->offset;
+    return lines;
+}
@@ -0,0 +1,76 @@
+#ifndef HOUGH_H
+#define HOUGH_H
+
+#include "bitmap.h"
+#include "../utils/thread_pool.h"
+
+// Straight lines through the ink of a Bitmap. A line is (theta, rho), the set
+// of points with (x - cx) cos(theta) + (y - cy) sin(theta) = rho, where (cx, cy)
+// = (w / 2, h / 2) is the image centre: theta = 0 is the vertical line
+// x = cx + rho, theta = 90 the horizontal line y = cy + rho. Angles are in
+// degrees and listed by the caller, so a search only pays for the angles it
+// needs (a few degrees around 0 and 90 for a page).
+
+#define HOUGH_CHUNK 1024
+
+// Ink points relative to the centre, extracted once and voted for any angles
+typedef struct {
+    float* xs;
+    float* ys;      // both padded with zeros to a whole number of HOUGH_CHUNK
+    int count;
+    int w;
+    int h;
+    Arena* arena;   // where the arrays come from (NULL: the heap)
+} HoughPoints;
+
+// Keeps every ink point, or one out of 2, 4... when there are more than
+// max_points (max_points <= 0: all of them), in a scrambled pattern: skipping
+// whole rows or columns (or diagonals) would leave empty bins at that angle and
+// make it look sharpest. The arrays come from arena. Returns 0, or -1 if out
+// of memory.
+int hough_points_init(HoughPoints* pts, const Bitmap* bm, int max_points, Arena* arena);
+void hough_points_free(HoughPoints* pts);
+
+// Accumulator: votes[t * rhos + bin] counts the points on line (theta[t], rho)
+// with bin = rho + offset, rho rounded down
+typedef struct {
+    int thetas;
+    double* theta;
+    float* cos_t;   // lookup tables of the listed angles
+    float* sin_t;
+    int rhos;
+    int offset;
+    int* votes;
+    Arena* arena;   // where the tables and votes come from (NULL: the heap)
+} HoughSpace;
+
+// Empty accumulator for the n angles of theta_deg, sized for the points' image,
+// taken from arena (as are the per-thread ones of hough_vote). Returns 0, or -1
+// if out of memory.
+int hough_init(HoughSpace* hs, const HoughPoints* pts, const double* theta_deg, int n, Arena* arena);
+void hough_free(HoughSpace* hs);
+
+// Adds the votes of every point for every angle. The points are split across
+// the pool's threads (NULL = current thread), each filling its own accumulator;
+// the sum does not depend on the split. Returns 0, or -1 if out of memory.
+int hough_vote(HoughSpace* hs, const HoughPoints* pts, ThreadPool* pool);
+
+static inline const int* hough_row(const HoughSpace* hs, int t) {
+    return hs->votes + (size_t)t * hs->rhos;
+}
+
+// Sum of the squared votes of angle t. The point count is fixed, so this is the
+// variance of the row up to a constant: it peaks at the angle where the ink
+// falls in the fewest bins, i.e. where the lines are straight.
+double hough_sharpness(const HoughSpace* hs, int t);
+
+// Index of the sharpest angle in [t0, t1)
+int hough_sharpest(const HoughSpace* hs, int t0, int t1);
+
+// Lines of angle t with at least min_votes points: each run of such bins is
+// one line, reported at its middle. Returns the rho of each line, in
+// increasing order (*count entries, from the arena of hs: arena_dealloc), or
+// NULL if out of memory.
+int* hough_peaks(const HoughSpace* hs, int t, int min_votes, int* count);
+
+#endif
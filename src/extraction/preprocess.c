@@ -1,249 +1,261 @@
 #include <SDL2/SDL.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include "preprocess.h"
+#include "denoiser.h"
+#include "bitmap.h"
 
 
-//DENOISER PART
+//PREPROCESS PART
 
-static Uint8 median(Uint8 a[], int size) {
-    // Simple bubble sort
-    for (int i = 0; i < size - 1; i++) {
-        for (int j = 0; j < size - i - 1; j++) {
-            if (a[j] > a[j + 1]) {
-                Uint8 tmp = a[j];
-                a[j] = a[j + 1];
-                a[j + 1] = tmp;
-            }
-        }
-    }
-    return a[size / 2];
-}
 
-static SDL_Surface* denoise_image(SDL_Surface* input) {
-    if (!input) {
-        fprintf(stderr, "[denoiser] Input surface is NULL\n");
-        return NULL;
-    }
-    
-    // Convert to 32-bit ARGB if needed
-    SDL_Surface* input_32 = NULL;
-    if (input->format->format != SDL_PIXELFORMAT_ARGB8888) {
-        input_32 = SDL_ConvertSurfaceFormat(input, SDL_PIXELFORMAT_ARGB8888, 0);
-        if (!input_32) {
-            fprintf(stderr, "[denoiser] Format conversion failed: %s\n", SDL_GetError());
-            return NULL;
+
+// One pass over an ARGB8888 image: luma plane Y (w*h bytes), its 256-bin
+// histogram and, if noise_score is not NULL, the mean variance of the 3x3
+// windows. The window sums come from running box sums over the last three luma
+// rows (an integral image evaluated on the fly), so each pixel costs O(1) and is
+// read while still in cache.
+// Typical noise scores: clean text image ~2-5, noisy/grainy ~20-80.
+static int luma_pass(SDL_Surface* img, uint8_t* Y, long hist[256], float* noise_score)
+{
+    int w = img->w, h = img->h;
+    int32_t* col_sum = NULL;
+    int32_t* col_sq = NULL;
+    if (noise_score) {
+        col_sum = (int32_t*)malloc(w * sizeof(int32_t));
+        col_sq = (int32_t*)malloc(w * sizeof(int32_t));
+        if (!col_sum || !col_sq) {
+            free(col_sum);
+            free(col_sq);
+            return -1;
         }
-    } else {
-        input_32 = input; // Already correct format
-    }
-    
-    // Create output surface
-    SDL_Surface* output = SDL_CreateRGBSurface(
-        0,
-        input_32->w, input_32->h,
-        32,
-        input_32->format->Rmask,
-        input_32->format->Gmask,
-        input_32->format->Bmask,
-        input_32->format->Amask
-    );
-    
-    if (!output) {
-        fprintf(stderr, "[denoiser] Surface creation error: %s\n", SDL_GetError());
-        if (input_32 != input) SDL_FreeSurface(input_32);
-        return NULL;
-    }
-    
-    SDL_LockSurface(input_32);
-    SDL_LockSurface(output);
-    
-    int w = input_32->w;
-    int h = input_32->h;
-    
-    // Copy border pixels as-is (no filtering)
-    Uint32* in_pixels = (Uint32*)input_32->pixels;
-    Uint32* out_pixels = (Uint32*)output->pixels;
-    
-    // Top and bottom rows
-    for (int x = 0; x < w; x++) {
-        out_pixels[x] = in_pixels[x]; // Top row
-        out_pixels[(h - 1) * w + x] = in_pixels[(h - 1) * w + x]; // Bottom row
     }
-    
-    // Left and right columns
+
+    memset(hist, 0, 256 * sizeof(long));
+    int64_t var_sum = 0;   // sum over windows of 81 * variance = 9*Q - S*S
+
+    if (SDL_MUSTLOCK(img)) SDL_LockSurface(img);
+
     for (int y = 0; y < h; y++) {
-        Uint32* out_row = (Uint32*)((Uint8*)output->pixels + y * output->pitch);
-        Uint32* in_row = (Uint32*)((Uint8*)input_32->pixels + y * input_32->pitch);
-        out_row[0] = in_row[0]; // Left column
-        out_row[w - 1] = in_row[w - 1]; // Right column
-    }
-    
-    // Apply 3x3 median filter to interior pixels
-    for (int y = 1; y < h - 1; y++) {
+        const uint32_t* row = (const uint32_t*)((const uint8_t*)img->pixels + y * img->pitch);
+        uint8_t* out = Y + (size_t)y * w;
+        for (int x = 0; x < w; x++) {
+            uint8_t v = pixel_luma(row[x]);
+            out[x] = v;
+            hist[v]++;
+        }
+
+        // Window rows y-2, y-1, y are ready: score the windows centered on row y-1
+        if (!noise_score || y < 2 || w < 3) continue;
+        const uint8_t* a = out - 2 * (size_t)w;
+        const uint8_t* b = out - w;
+        for (int x = 0; x < w; x++) {
+            col_sum[x] = a[x] + b[x] + out[x];
+            col_sq[x] = a[x] * a[x] + b[x] * b[x] + out[x] * out[x];
+        }
+        int32_t s = col_sum[0] + col_sum[1];
+        int32_t q = col_sq[0] + col_sq[1];
         for (int x = 1; x < w - 1; x++) {
-            Uint8 r[9], g[9], b[9];
-            int idx = 0;
-            
-            // Collect 3x3 neighborhood
-            for (int dy = -1; dy <= 1; dy++) {
-                Uint32* row = (Uint32*)((Uint8*)input_32->pixels + (y + dy) * input_32->pitch);
-                
-                for (int dx = -1; dx <= 1; dx++) {
-                    Uint32 pixel = row[x + dx];
-                    
-                    Uint8 R, G, B;
-                    SDL_GetRGB(pixel, input_32->format, &R, &G, &B);
-                    
-                    r[idx] = R;
-                    g[idx] = G;
-                    b[idx] = B;
-                    idx++;
-                }
-            }
-            
-            // Apply median to each channel
-            Uint32* out_row = (Uint32*)((Uint8*)output->pixels + y * output->pitch);
-            out_row[x] = SDL_MapRGB(output->format,
-                                    median(r, 9),
-                                    median(g, 9),
-                                    median(b, 9));
+            s += col_sum[x + 1];
+            q += col_sq[x + 1];
+            var_sum += 9 * (int64_t)q - (int64_t)s * s;
+            s -= col_sum[x - 1];
+            q -= col_sq[x - 1];
         }
     }
-    
-    SDL_UnlockSurface(input_32);
-    SDL_UnlockSurface(output);
-    
-    // Free temporary surface if we created one
-    if (input_32 != input) {
-        SDL_FreeSurface(input_32);
-    }
-    
-    printf("[denoiser] ✓ Median filter applied (%dx%d)\n", w, h);
-    
-    return output;
-}
-
-
 
+    if (SDL_MUSTLOCK(img)) SDL_UnlockSurface(img);
 
+    if (noise_score) {
+        long windows = (w > 2 && h > 2) ? (long)(w - 2) * (h - 2) : 0;
+        *noise_score = windows ? (float)((double)var_sum / 81.0 / windows) : 0.0f;
+        free(col_sum);
+        free(col_sq);
+    }
+    return 0;
+}
 
+// ISODATA on a histogram: O(256) per iteration instead of O(N)
+int isodata_threshold_hist(const long hist[256]) {
+    long n = 0, sum = 0;
+    for (int v = 0; v < 256; v++) {
+        n += hist[v];
+        sum += (long)v * hist[v];
+    }
+    if (n == 0) return 0;
 
-//PREPROCESS PART
+    int t = (int)(sum / n);
+    int prev = -1;
 
+    while (t != prev) {
+        prev = t;
+        long s0 = 0, n0 = 0;
+        for (int v = 0; v <= t; v++) {
+            s0 += (long)v * hist[v];
+            n0 += hist[v];
+        }
+        long s1 = sum - s0, n1 = n - n0;
+        int m0 = n0 ? (int)(s0 / n0) : t;
+        int m1 = n1 ? (int)(s1 / n1) : t;
+        t = (m0 + m1) / 2;
+    }
+    return t;
+}
 
+int isodata_threshold(const uint8_t *Y, int n) {
+    long hist[256] = {0};
+    for (int i = 0; i < n; i++) hist[Y[i]]++;
+    return isodata_threshold_hist(hist);
+}
 
-static inline uint8_t gray_from_rgb(uint32_t px) {
-    uint8_t r = (px >> 16) & 0xFF;
-    uint8_t g = (px >> 8) & 0xFF;
-    uint8_t b = px & 0xFF;
-    return (uint8_t)((77 * r + 150 * g + 29 * b) >> 8);
+int binarize_method_parse(const char* name, BinarizeMethod* method) {
+    if (!name) return -1;
+    if (strcmp(name, "isodata") == 0) *method = BINARIZE_ISODATA;
+    else if (strcmp(name, "sauvola") == 0) *method = BINARIZE_SAUVOLA;
+    else if (strcmp(name, "bradley") == 0) *method = BINARIZE_BRADLEY;
+    else return -1;
+    return 0;
 }
 
-static int is_image_noisy(SDL_Surface* surf, float* out_score)
-{
-    if (!surf) return 0;
+const char* binarize_method_name(BinarizeMethod method) {
+    switch (method) {
+        case BINARIZE_SAUVOLA: return "sauvola";
+        case BINARIZE_BRADLEY: return "bradley";
+        default: return "isodata";
+    }
+}
 
-    SDL_Surface* img = SDL_ConvertSurfaceFormat(surf, SDL_PIXELFORMAT_ARGB8888, 0);
-    if (!img) return 0;
+// Adaptive thresholds: each pixel is compared with statistics of the
+// (2r+1)x(2r+1) window around it (clamped to the image), read from summed-area
+// tables in O(1) whatever the window size.
+#define ADAPTIVE_MAX_RADIUS 128     // keeps the window sums of Y² below 2^32
+#define SAUVOLA_K 0.2
+#define SAUVOLA_R 128.0
+#define BRADLEY_T 15                // % below the local mean to count as ink
+
+static int adaptive_radius(int w, int h) {
+    // a few letters wide on a typical scan
+    int r = (w < h ? w : h) / 32;
+    if (r < 7) r = 7;
+    if (r > ADAPTIVE_MAX_RADIUS) r = ADAPTIVE_MAX_RADIUS;
+    return r;
+}
 
-    int w = img->w, h = img->h;
-    float total_var = 0.0f;
-    int count = 0;
+// Writes the black/white image of Y into bw. Returns 0, or -1 if out of memory
+static int adaptive_threshold(const uint8_t* Y, int w, int h, BinarizeMethod method, SDL_Surface* bw) {
+    // (w+1) x (h+1) tables with a zero first row and column. uint32 sums wrap on
+    // big images, but the difference of four entries is still the exact window
+    // sum as long as that sum fits in 32 bits.
+    size_t stride = (size_t)w + 1;
+    size_t size = stride * ((size_t)h + 1);
+    int sauvola = method == BINARIZE_SAUVOLA;
+    uint32_t* sum = (uint32_t*)calloc(size, sizeof(uint32_t));
+    uint32_t* sq = sauvola ? (uint32_t*)calloc(size, sizeof(uint32_t)) : NULL;
+    if (!sum || (sauvola && !sq)) {
+        free(sum);
+        free(sq);
+        return -1;
+    }
 
-    SDL_LockSurface(img);
+    for (int y = 0; y < h; y++) {
+        const uint8_t* row = Y + (size_t)y * w;
+        const uint32_t* above = sum + (size_t)y * stride;
+        uint32_t* cur = sum + (size_t)(y + 1) * stride;
+        uint32_t row_sum = 0;
+        for (int x = 0; x < w; x++) {
+            row_sum += row[x];
+            cur[x + 1] = above[x + 1] + row_sum;
+        }
+        if (!sauvola) continue;
+        const uint32_t* above_sq = sq + (size_t)y * stride;
+        uint32_t* cur_sq = sq + (size_t)(y + 1) * stride;
+        uint32_t row_sq = 0;
+        for (int x = 0; x < w; x++) {
+            row_sq += (uint32_t)row[x] * row[x];
+            cur_sq[x + 1] = above_sq[x + 1] + row_sq;
+        }
+    }
 
-    for (int y = 1; y < h - 1; y++) {
-        Uint32* row_m1 = (Uint32*)((Uint8*)img->pixels + (y - 1) * img->pitch);
-        Uint32* row_0  = (Uint32*)((Uint8*)img->pixels +  y      * img->pitch);
-        Uint32* row_p1 = (Uint32*)((Uint8*)img->pixels + (y + 1) * img->pitch);
+    int r = adaptive_radius(w, h);
+    printf("[preprocess] Threshold (%s) = local, %dx%d window\n",
+           binarize_method_name(method), 2 * r + 1, 2 * r + 1);
 
-        for (int x = 1; x < w - 1; x++) {
-            // Collect 3×3 grayscale values
-            float v[9];
-            int k = 0;
-
-            Uint32 pixels[3][3] = {
-                { row_m1[x-1], row_m1[x], row_m1[x+1] },
-                { row_0 [x-1], row_0 [x], row_0 [x+1] },
-                { row_p1[x-1], row_p1[x], row_p1[x+1] }
-            };
-
-            for (int j = 0; j < 3; j++)
-            for (int i = 0; i < 3; i++) {
-                Uint8 r, g, b;
-                SDL_GetRGB(pixels[j][i], img->format, &r, &g, &b);
-                v[k++] = 0.299f*r + 0.587f*g + 0.114f*b; // grayscale
+    if (SDL_MUSTLOCK(bw)) SDL_LockSurface(bw);
+    for (int y = 0; y < h; y++) {
+        int y0 = y - r > 0 ? y - r : 0;
+        int y1 = y + r + 1 < h ? y + r + 1 : h;
+        const uint32_t* top = sum + (size_t)y0 * stride;
+        const uint32_t* bottom = sum + (size_t)y1 * stride;
+        const uint32_t* top_sq = sauvola ? sq + (size_t)y0 * stride : NULL;
+        const uint32_t* bottom_sq = sauvola ? sq + (size_t)y1 * stride : NULL;
+        const uint8_t* row = Y + (size_t)y * w;
+        uint32_t* q = (uint32_t*)((uint8_t*)bw->pixels + y * bw->pitch);
+
+        for (int x = 0; x < w; x++) {
+            int x0 = x - r > 0 ? x - r : 0;
+            int x1 = x + r + 1 < w ? x + r + 1 : w;
+            uint32_t area = (uint32_t)(x1 - x0) * (uint32_t)(y1 - y0);
+            uint32_t s = bottom[x1] - bottom[x0] - top[x1] + top[x0];
+
+            int black;
+            if (sauvola) {
+                uint32_t s2 = bottom_sq[x1] - bottom_sq[x0] - top_sq[x1] + top_sq[x0];
+                double mean = (double)s / area;
+                double var = (double)s2 / area - mean * mean;
+                double sd = var > 0.0 ? sqrt(var) : 0.0;
+                black = row[x] <= mean * (1.0 + SAUVOLA_K * (sd / SAUVOLA_R - 1.0));
+            } else {
+                black = (uint64_t)row[x] * area * 100 <= (uint64_t)s * (100 - BRADLEY_T);
             }
-
-            // compute variance
-            float mean = 0;
-            for (int i = 0; i < 9; i++) mean += v[i];
-            mean /= 9.0f;
-
-            float var = 0;
-            for (int i = 0; i < 9; i++)
-                var += (v[i] - mean) * (v[i] - mean);
-
-            var /= 9.0f;
-
-            total_var += var;
-            count++;
+            q[x] = black ? 0xFF000000u : 0xFFFFFFFFu;
         }
     }
+    if (SDL_MUSTLOCK(bw)) SDL_UnlockSurface(bw);
 
-    SDL_UnlockSurface(img);
-    SDL_FreeSurface(img);
-
-    float score = (count > 0 ? total_var / count : 0);
-
-    if (out_score) *out_score = score;
-
-    // Typical values:
-    // Clean text image: ~2–5
-    // Noisy/grainy:     ~20–80
-    return score > 10.0f;
+    free(sum);
+    free(sq);
+    return 0;
 }
 
-int isodata_threshold(const uint8_t *Y, int n) {
-    long sum = 0;
-    for (int i = 0; i < n; i++) sum += Y[i];
-
-    int t = (int)(sum / n);
-    int prev = -1;
-
-    while (t != prev) {
-        prev = t;
-        long s0 = 0, s1 = 0;
-        int n0 = 0, n1 = 0;
-
-        for (int i = 0; i < n; i++) {
-            if (Y[i] <= t) {
-                s0 += Y[i];
-                n0++;
-            } else {
-                s1 += Y[i];
-                n1++;
-            }
+static void global_threshold(const uint8_t* Y, int w, int h, int t, SDL_Surface* bw) {
+    if (SDL_MUSTLOCK(bw)) SDL_LockSurface(bw);
+    for (int y = 0; y < h; y++) {
+        uint32_t* q = (uint32_t*)((uint8_t*)bw->pixels + y * bw->pitch);
+        const uint8_t* row = Y + (size_t)y * w;
+        for (int x = 0; x < w; x++) {
+            q[x] = (row[x] <= t) ? 0xFF000000u : 0xFFFFFFFFu;
         }
-        int m0 = n0 ? (int)(s0 / n0) : t;
-        int m1 = n1 ? (int)(s1 / n1) : t;
-        t = (m0 + m1) / 2;
     }
-    return t;
+    if (SDL_MUSTLOCK(bw)) SDL_UnlockSurface(bw);
 }
 
-SDL_Surface* binarize_image(const char* input_path) {
-    SDL_Surface* src = SDL_LoadBMP(input_path);
-    if (!src) {
-        fprintf(stderr, "[preprocess] Failed to load BMP: %s\n", SDL_GetError());
-        return NULL;
+SDL_Surface* binarize_surface(SDL_Surface* src, BinarizeMethod method, ThreadPool* pool) {
+    // Work on src directly when it is already ARGB8888
+    SDL_Surface* img = src;
+    if (src->format->format != SDL_PIXELFORMAT_ARGB8888) {
+        img = SDL_ConvertSurfaceFormat(src, SDL_PIXELFORMAT_ARGB8888, 0);
+        if (!img) {
+            fprintf(stderr, "[preprocess] Format conversion failed: %s\n", SDL_GetError());
+            return NULL;
+        }
     }
 
-    // Detect noise using 3x3 variance method
+    int W = img->w, H = img->h, N = W * H;
+    uint8_t* Y = (uint8_t*)malloc(N);
+    long hist[256];
+
+    // Luma, histogram and noise score (3x3 variance method) in a single pass
     float noise_score = 0.0f;
-    int is_noisy = is_image_noisy(src, &noise_score);
+    if (!Y || luma_pass(img, Y, hist, &noise_score) != 0) {
+        fprintf(stderr, "[preprocess] Out of memory\n");
+        free(Y);
+        if (img != src) SDL_FreeSurface(img);
+        return NULL;
+    }
+    int is_noisy = noise_score > 10.0f;
     
     //DESACTIVATEUR !!
     is_noisy = 0;
@@ -251,69 +263,61 @@ SDL_Surface* binarize_image(const char* input_path) {
     printf("[preprocess] Noise score: %.2f -> %s\n", 
            noise_score, is_noisy ? "NOISY" : "CLEAN");
     
-    SDL_Surface* img = NULL;
-    
     // Apply denoising if needed
     if (is_noisy) {
         printf("[preprocess] Applying median filter denoising...\n");
         
-        SDL_Surface* denoised = denoise_image(src);
-        SDL_FreeSurface(src);
+        // If very noisy (score > 30), apply a second pass, fused with the first one
+        int passes = noise_score > 30.0f ? 2 : 1;
+        if (passes > 1)
+            printf("[preprocess] Very noisy (%.2f), applying second pass...\n", noise_score);
+
+        SDL_Surface* denoised = denoise_image_passes(img, 1, passes, pool);
+        if (img != src) SDL_FreeSurface(img);
         
-        if (!denoised) {
+        // the denoiser keeps the ARGB8888 layout
+        img = denoised;
+        if (!img || luma_pass(img, Y, hist, NULL) != 0) {
             fprintf(stderr, "[preprocess] Denoising failed\n");
+            free(Y);
+            SDL_FreeSurface(img);
             return NULL;
         }
-        
-        // If very noisy (score > 30), apply second pass
-        if (noise_score > 30.0f) {
-            printf("[preprocess] Very noisy (%.2f), applying second pass...\n", noise_score);
-            SDL_Surface* denoised2 = denoise_image(denoised);
-            SDL_FreeSurface(denoised);
-            denoised = denoised2;
-        }
-        
-        img = SDL_ConvertSurfaceFormat(denoised, SDL_PIXELFORMAT_ARGB8888, 0);
-        SDL_FreeSurface(denoised);
     } else {
         // Clean - no denoising
         printf("[preprocess] Clean image, skipping denoising\n");
-        img = SDL_ConvertSurfaceFormat(src, SDL_PIXELFORMAT_ARGB8888, 0);
-        SDL_FreeSurface(src);
     }
-    
-    if (!img) {
-        fprintf(stderr, "[preprocess] Format conversion failed: %s\n", SDL_GetError());
+    if (img != src) SDL_FreeSurface(img);
+
+    SDL_Surface* bw = SDL_CreateRGBSurfaceWithFormat(0, W, H, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!bw) {
+        fprintf(stderr, "[preprocess] Surface creation error: %s\n", SDL_GetError());
+        free(Y);
         return NULL;
     }
 
-    if (SDL_MUSTLOCK(img)) SDL_LockSurface(img);
-
-    int W = img->w, H = img->h, N = W * H;
-    uint32_t* p = (uint32_t*)img->pixels;
-
-    uint8_t* Y = (uint8_t*)calloc(1, N);
-    
-    for (int i = 0; i < N; i++) {
-        Y[i] = gray_from_rgb(p[i]);
+    if (method == BINARIZE_ISODATA) {
+        int t = isodata_threshold_hist(hist);
+        printf("[preprocess] Threshold (ISODATA) = %d\n", t);
+        global_threshold(Y, W, H, t, bw);
+    } else if (adaptive_threshold(Y, W, H, method, bw) != 0) {
+        fprintf(stderr, "[preprocess] Out of memory\n");
+        SDL_FreeSurface(bw);
+        bw = NULL;
     }
-    
-    int t = isodata_threshold(Y, N);
-    printf("[preprocess] Threshold (ISODATA) = %d\n", t);
 
-    SDL_Surface* bw = SDL_CreateRGBSurfaceWithFormat(0, W, H, 32, SDL_PIXELFORMAT_ARGB8888);
-    if (SDL_MUSTLOCK(bw)) SDL_LockSurface(bw);
-    
-    uint32_t* q = (uint32_t*)bw->pixels;
-    for (int i = 0; i < N; i++) {
-        uint8_t v = (Y[i] <= t) ? 0 : 255;
-        q[i] = (0xFF << 24) | (v << 16) | (v << 8) | v;
-    }
+    free(Y);
+    return bw;
+}
 
-    if (SDL_MUSTLOCK(bw)) SDL_UnlockSurface(bw);
-    if (SDL_MUSTLOCK(img)) SDL_UnlockSurface(img);
+SDL_Surface* binarize_image(const char* input_path, BinarizeMethod method, ThreadPool* pool) {
+    SDL_Surface* src = SDL_LoadBMP(input_path);
+    if (!src) {
+        fprintf(stderr, "[preprocess] Failed to load BMP: %s\n", SDL_GetError());
+        return NULL;
+    }
 
-    free(Y);
-    SDL_FreeSurface(img);
+    SDL_Surface* bw = binarize_surface(src, method, pool);
+    SDL_FreeSurface(src);
     return bw;
 }
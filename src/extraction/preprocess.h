@@ -1,7 +1,26 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include "../utils/thread_pool.h"
 
 
-SDL_Surface* binarize_image(const char* input_path);
+typedef enum {
+    BINARIZE_ISODATA,   // one global threshold for the whole image (default)
+    BINARIZE_SAUVOLA,   // local: T = mean * (1 + k * (deviation / R - 1))
+    BINARIZE_BRADLEY    // local: ink if darker than the window mean by t%
+} BinarizeMethod;
+
+// "isodata", "sauvola" or "bradley"; returns 0, or -1 if unknown
+int binarize_method_parse(const char* name, BinarizeMethod* method);
+const char* binarize_method_name(BinarizeMethod method);
+
+// Loads a BMP and returns it as black/white ARGB8888.
+// pool: threads for the median denoiser (NULL = current thread)
+SDL_Surface* binarize_image(const char* input_path, BinarizeMethod method, ThreadPool* pool);
+
+// Same on an image already in memory (src is not freed)
+SDL_Surface* binarize_surface(SDL_Surface* src, BinarizeMethod method, ThreadPool* pool);
 
 int isodata_threshold(const uint8_t* gray, int n);
+
+// Same threshold computed from a 256-bin luma histogram
+int isodata_threshold_hist(const long hist[256]);
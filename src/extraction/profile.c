@@ -0,0 +1,99 @@
+#include "profile.h"
+#include <string.h>
+
+#ifndef OCR_SIMD
+#define OCR_SIMD 1
+#endif
+
+#if OCR_SIMD && defined(__SSE2__)
+#define HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define HAVE_SSE2 0
+#endif
+
+// Words of a row whose column counters are kept at once (1024 columns, 1 KB of
+// counters): a wider region is done in several strips
+#define PROFILE_STRIP 16
+
+// A byte counter overflows after 255 rows
+#define PROFILE_FLUSH 255
+
+// cnt[i] += bit i of v, for the 64 columns of a word
+static inline void add_word(uint8_t* cnt, uint64_t v) {
+#if HAVE_SSE2
+    // each 16 bits of v spread over the 16 bytes of a register, compared with
+    // their own bit: 0xFF (-1) where set, subtracted from the counters
+    const __m128i bits = _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+    for (int q = 0; q < 4; q++) {
+        __m128i t = _mm_cvtsi32_si128((int)((v >> (16 * q)) & 0xFFFF));
+        t = _mm_unpacklo_epi8(t, t);
+        t = _mm_unpacklo_epi16(t, t);
+        t = _mm_unpacklo_epi32(t, t);
+        t = _mm_cmpeq_epi8(_mm_and_si128(t, bits), bits);
+        __m128i* c = (__m128i*)(cnt + 16 * q);
+        _mm_store_si128(c, _mm_sub_epi8(_mm_load_si128(c), t));
+    }
+#else
+    // each byte of v copied to the 8 bytes of a uint64, byte i keeping bit i,
+    // then moved to the low bit of its byte (adding 0x7F never carries out)
+    const uint64_t low = 0x0101010101010101ULL;
+    for (int j = 0; j < 8; j++) {
+        uint64_t b = (v >> (8 * j)) & 0xFF;
+        uint64_t spread = ((((b * low) & 0x8040201008040201ULL) + 0x7F7F7F7F7F7F7F7FULL) >> 7) & low;
+        uint64_t c;
+        memcpy(&c, cnt + 8 * j, sizeof(c));
+        c += spread;
+        memcpy(cnt + 8 * j, &c, sizeof(c));
+    }
+#endif
+}
+
+// cols[X - x] += the counter of column X, for X in [x0, x1); counters reset
+static void flush_counts(uint8_t* cnt, int n, int first_col, int x, int x0, int x1, int* cols) {
+    for (int i = 0; i < n; i++) {
+        int X = first_col + i;
+        if (X >= x0 && X < x1) cols[X - x] += cnt[i];
+    }
+    memset(cnt, 0, (size_t)n);
+}
+
+void profile_region(const Bitmap* bm, int x, int y, int w, int h, int* rows, int* cols) {
+    if (rows && h > 0) memset(rows, 0, sizeof(int) * (size_t)h);
+    if (cols && w > 0) memset(cols, 0, sizeof(int) * (size_t)w);
+
+    int x0 = x < 0 ? 0 : x, x1 = x + w > bm->w ? bm->w : x + w;
+    int y0 = y < 0 ? 0 : y, y1 = y + h > bm->h ? bm->h : y + h;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    int k0 = x0 >> 6, k1 = (x1 - 1) >> 6;
+    uint64_t head = ~(uint64_t)0 << (x0 & 63);
+    uint64_t tail = ~(uint64_t)0 >> (63 - ((x1 - 1) & 63));
+
+    _Alignas(16) uint8_t cnt[PROFILE_STRIP * 64];
+    for (int s = k0; s <= k1; s += PROFILE_STRIP) {
+        int e = s + PROFILE_STRIP <= k1 + 1 ? s + PROFILE_STRIP : k1 + 1;
+        int n = (e - s) * 64;
+        memset(cnt, 0, (size_t)n);
+
+        int pending = 0;
+        for (int r = y0; r < y1; r++) {
+            const uint64_t* row = bitmap_row(bm, r);
+            int ink = 0;
+            for (int k = s; k < e; k++) {
+                uint64_t v = row[k];
+                if (k == k0) v &= head;
+                if (k == k1) v &= tail;
+                if (!v) continue;
+                ink += __builtin_popcountll(v);
+                if (cols) add_word(cnt + (k - s) * 64, v);
+            }
+            if (rows) rows[r - y] += ink;
+            if (cols && ++pending == PROFILE_FLUSH) {
+                flush_counts(cnt, n, s * 64, x, x0, x1, cols);
+                pending = 0;
+            }
+        }
+        if (cols && pending) flush_counts(cnt, n, s * 64, x, x0, x1, cols);
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "bitmap.h"
+
+// Projection profiles of a Bitmap: the ink of every row and every column of a
+// region, counted together in one pass down its rows. A column count is kept
+// in a byte per column, 16 columns added at once (SSE2, or 8 at a time in a
+// uint64 when compiled with OCR_SIMD=0), and folded into the int profile every
+// 255 rows: the cost no longer depends on the ink, and the rows are read in
+// memory order however tall the region is.
+
+// rows[i] = ink pixels of row y + i and cols[j] = ink pixels of column x + j,
+// within the w x h region at (x, y). The parts of the region outside the
+// bitmap count 0. Either array may be NULL.
+void profile_region(const Bitmap* bm, int x, int y, int w, int h, int* rows, int* cols);
+
+#endif
@@ -1,127 +1,129 @@
 
 #include "slice_grid.h"
+#include "bitmap.h"
+#include "hough.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdbool.h>
-#include <stdint.h>
 
-static inline bool is_black(uint32_t px) {
-    return ((px & 0x00FFFFFF) == 0);
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Largest tilt of a divider line: extract_grid already deskewed the page to
+// within half a degree
+#define LINE_RANGE 1.0
+#define LINE_STEP 0.25
+#define LINE_ANGLES 9
+
+// Divider (theta, rho) in the Hough convention of a W x H grid: y of a row
+// line (theta near 90) at column x, x of a column line (theta near 0) at row y
+static double row_line_y(double theta, int rho, double x, int W, int H) {
+    double rad = theta * M_PI / 180.0;
+    return H / 2 + (rho - (x - W / 2) * cos(rad)) / sin(rad);
 }
 
-static void build_profile_rows(SDL_Surface* s, int* H) {
-    uint8_t* base = (uint8_t*)s->pixels;
-    int pitch = s->pitch;
-    for (int y = 0; y < s->h; y++) {
-        uint32_t* row = (uint32_t*)(base + y * pitch);
-        int cnt = 0;
-        for (int x = 0; x < s->w; x++) {
-            if (is_black(row[x])) cnt++;
-        }
-        H[y] = cnt;
-    }
+static double col_line_x(double theta, int rho, double y, int W, int H) {
+    double rad = theta * M_PI / 180.0;
+    return W / 2 + (rho - (y - H / 2) * sin(rad)) / cos(rad);
 }
 
-static void build_profile_cols(SDL_Surface* s, int* V) {
-    uint8_t* base = (uint8_t*)s->pixels;
-    int pitch = s->pitch;
-    for (int x = 0; x < s->w; x++) {
-        int cnt = 0;
-        for (int y = 0; y < s->h; y++) {
-            uint32_t* row = (uint32_t*)(base + y * pitch);
-            if (is_black(row[x])) cnt++;
-        }
-        V[x] = cnt;
+static int cut_grid(const Bitmap* grid, GlyphSet* cells, ThreadPool* pool, Arena* scratch) {
+    // the cells are views of the grid bitmap, which the set keeps
+    if (glyph_set_load(cells, grid) != 0) return -1;
+    const Bitmap* bm = &cells->source;
+
+    // One Hough vote for both families: rows around 90 degrees, columns around
+    // 0. A slightly tilted line still peaks sharply at its own angle, where a
+    // plain row profile spread it over several rows, each under the threshold.
+    double thetas[2 * LINE_ANGLES];
+    for (int i = 0; i < LINE_ANGLES; i++) {
+        thetas[i] = 90.0 - LINE_RANGE + i * LINE_STEP;
+        thetas[LINE_ANGLES + i] = -LINE_RANGE + i * LINE_STEP;
     }
-}
 
-static int* find_line_positions(const int* prof, int N, int thr, int* out_count) {
-    int* bands = (int*)malloc(sizeof(int) * 100);
-    int count = 0;
-    int in_band = 0, band_start = 0;
-    
-    for (int i = 0; i < N; i++) {
-        if (prof[i] >= thr) {
-            if (!in_band) { 
-                band_start = i; 
-                in_band = 1; 
-            }
-        } else {
-            if (in_band) {
-                bands[count++] = (band_start + i - 1) / 2;
-                in_band = 0;
-            }
-        }
-    }
-    if (in_band) {
-        bands[count++] = (band_start + N - 1) / 2;
+    HoughPoints pts;
+    HoughSpace hs;
+    if (hough_points_init(&pts, bm, 0, scratch) != 0) return -1;
+    if (hough_init(&hs, &pts, thetas, 2 * LINE_ANGLES, scratch) != 0 || hough_vote(&hs, &pts, pool) != 0) {
+        hough_free(&hs);
+        hough_points_free(&pts);
+        return -1;
     }
-    
-    *out_count = count;
-    return bands;
-}
-
-int slice_grid(SDL_Surface* grid, const char* output_dir) {
-    if (!grid || !output_dir) return -1;
+    hough_points_free(&pts);
 
-    if (SDL_MUSTLOCK(grid)) SDL_LockSurface(grid);
-
-    int W = grid->w, H = grid->h;
-    int* Hprof = (int*)calloc(H, sizeof(int));
-    int* Vprof = (int*)calloc(W, sizeof(int));
-
-    build_profile_rows(grid, Hprof);
-    build_profile_cols(grid, Vprof);
+    int W = bm->w, H = bm->h;
+    int t_row = hough_sharpest(&hs, 0, LINE_ANGLES);
+    int t_col = hough_sharpest(&hs, LINE_ANGLES, 2 * LINE_ANGLES);
 
+    // a divider crosses the whole grid: at least half of it must be inked
     int thr_row = (int)(0.5 * W);
     int thr_col = (int)(0.5 * H);
 
     int nr = 0, nc = 0;
-    int* rbands = find_line_positions(Hprof, H, thr_row, &nr);
-    int* cbands = find_line_positions(Vprof, W, thr_col, &nc);
-
-    free(Hprof); free(Vprof);
+    int* rbands = hough_peaks(&hs, t_row, thr_row, &nr);
+    int* cbands = hough_peaks(&hs, t_col, thr_col, &nc);
+    hough_free(&hs);
+    if (!rbands || !cbands) {
+        arena_dealloc(scratch, rbands); arena_dealloc(scratch, cbands);
+        return -1;
+    }
 
+    if (thetas[t_row] != 90.0 || thetas[t_col] != 0.0)
+        printf("[slice_grid] Lines tilted: rows %.2f, cols %.2f degrees\n",
+               thetas[t_row] - 90.0, thetas[t_col]);
     printf("[slice_grid] Detected %d row lines, %d col lines\n", nr, nc);
 
     if (nr < 2 || nc < 2) {
         fprintf(stderr, "[slice_grid] ERROR: not enough divider lines\n");
-        free(rbands); free(cbands);
-        if (SDL_MUSTLOCK(grid)) SDL_UnlockSurface(grid);
+        arena_dealloc(scratch, rbands); arena_dealloc(scratch, cbands);
         return -2;
     }
 
     int R = nr - 1, C = nc - 1;
     printf("[slice_grid] Detected %dx%d grid\n", R, C);
 
-    if (SDL_MUSTLOCK(grid)) SDL_UnlockSurface(grid);
+    cells->rows = R;
+    cells->cols = C;
 
-    char path[512];
     int trim = 3;
     int saved = 0;
+    double tr = thetas[t_row], tc = thetas[t_col];
 
+    // Each cell is cut between the four lines around it where they pass the
+    // cell: across the grid a line tilted by a degree drifts more than trim,
+    // across one cell it does not
     for (int r = 0; r < R; r++) {
         for (int c = 0; c < C; c++) {
-            int x0 = cbands[c] + trim;
-            int x1 = cbands[c + 1] - trim;
-            int y0 = rbands[r] + trim;
-            int y1 = rbands[r + 1] - trim;
+            double xm = (col_line_x(tc, cbands[c], H / 2, W, H) + col_line_x(tc, cbands[c + 1], H / 2, W, H)) / 2;
+            double top = row_line_y(tr, rbands[r], xm, W, H);
+            double bottom = row_line_y(tr, rbands[r + 1], xm, W, H);
+            double ym = (top + bottom) / 2;
+            double left = col_line_x(tc, cbands[c], ym, W, H);
+            double right = col_line_x(tc, cbands[c + 1], ym, W, H);
+
+            int x0 = (int)lround(left) + trim;
+            int x1 = (int)lround(right) - trim;
+            int y0 = (int)lround(top) + trim;
+            int y1 = (int)lround(bottom) - trim;
 
             if (x1 <= x0 || y1 <= y0) continue;
 
-            SDL_Rect rc = { x0, y0, x1 - x0, y1 - y0 };
-            SDL_Surface* cell = SDL_CreateRGBSurfaceWithFormat(0, rc.w, rc.h, 32, SDL_PIXELFORMAT_ARGB8888);
-            SDL_Rect dst = { 0, 0, 0, 0 };
-            SDL_BlitSurface(grid, &rc, cell, &dst);
-
-            snprintf(path, sizeof(path), "%s/c_%02d_%02d.bmp", output_dir, r, c);
-            SDL_SaveBMP(cell, path);
-            SDL_FreeSurface(cell);
-            saved++;
+            SDL_Rect cell = { x0, y0, x1 - x0, y1 - y0 };
+            if (glyph_set_push(cells, cell, cell, 0, r, c) == 0) saved++;
         }
     }
 
-    free(rbands); free(cbands);
-    printf("[slice_grid] Saved %d cells to %s\n", saved, output_dir);
+    arena_dealloc(scratch, rbands); arena_dealloc(scratch, cbands);
+    printf("[slice_grid] Sliced %d cells\n", saved);
     return 0;
 }
+
+int slice_grid(const Bitmap* grid, GlyphSet* cells, ThreadPool* pool, Arena* scratch) {
+    if (!grid || !cells) return -1;
+
+    ArenaMark mark = arena_mark(scratch);
+    int res = cut_grid(grid, cells, pool, scratch);
+    arena_release(scratch, mark);
+    return res;
+}
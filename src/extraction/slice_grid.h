@@ -1,5 +1,13 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include "glyph_set.h"
+#include "../utils/thread_pool.h"
+#include "../utils/arena.h"
 
 
-int slice_grid(SDL_Surface* grid, const char* output_dir);
+// Cuts the grid along its divider lines, found by a Hough vote over a degree
+// around the axes (pool: its threads, NULL = current thread); a copy of the
+// grid becomes the bitmap of `cells` and the cells are appended as views of
+// it. The work buffers come from scratch (NULL = heap), which is left as it
+// was found.
+int slice_grid(const Bitmap* grid, GlyphSet* cells, ThreadPool* pool, Arena* scratch);
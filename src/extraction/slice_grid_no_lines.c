@@ -1,8 +1,8 @@
 #include "slice_grid_no_lines.h"
+#include "bitmap.h"
+#include "profile.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdbool.h>
-#include <stdint.h>
 #include <math.h>
 
 // --- Outils de comparaison pour le tri (nécessaire pour la médiane) ---
@@ -10,40 +10,6 @@ static int compare_ints(const void* a, const void* b) {
     return (*(int*)a - *(int*)b);
 }
 
-// --- Détection de pixel noir ---
-static inline bool is_black(uint32_t px) {
-    uint8_t r = (px >> 16) & 0xFF;
-    uint8_t g = (px >> 8) & 0xFF;
-    uint8_t b = px & 0xFF;
-    // On est tolérant : tout ce qui n'est pas presque blanc est considéré comme de l'encre
-    return (r < 200 || g < 200 || b < 200); 
-}
-
-// --- Construction des histogrammes ---
-static void build_profile_rows(SDL_Surface* s, int* H) {
-    uint8_t* base = (uint8_t*)s->pixels;
-    for (int y = 0; y < s->h; y++) {
-        int cnt = 0;
-        for (int x = 0; x < s->w; x++) {
-            uint32_t px = ((uint32_t*)(base + y * s->pitch))[x];
-            if (is_black(px)) cnt++;
-        }
-        H[y] = cnt;
-    }
-}
-
-static void build_profile_cols(SDL_Surface* s, int* V) {
-    uint8_t* base = (uint8_t*)s->pixels;
-    for (int x = 0; x < s->w; x++) {
-        int cnt = 0;
-        for (int y = 0; y < s->h; y++) {
-            uint32_t px = ((uint32_t*)(base + y * s->pitch))[x];
-            if (is_black(px)) cnt++;
-        }
-        V[x] = cnt;
-    }
-}
-
 // --- Algorithme Intelligent de Découpe ---
 
 // Cette structure stocke les limites d'une case potentielle
@@ -56,9 +22,9 @@ typedef struct {
 // 1. Trouve les zones de densité.
 // 2. Calcule la médiane.
 // 3. Découpe les zones trop larges.
-static Range* get_smart_cuts(int* profile, int length, int threshold, int* out_count) {
+static Range* get_smart_cuts(int* profile, int length, int threshold, int* out_count, Arena* scratch) {
     // Étape 1 : Trouver les segments "bruts" (là où il y a du noir)
-    Range* raw_ranges = malloc(sizeof(Range) * length); // Allocation large
+    Range* raw_ranges = arena_alloc(scratch, sizeof(Range) * length); // Allocation large
     int raw_count = 0;
     
     int start = -1;
@@ -85,33 +51,39 @@ static Range* get_smart_cuts(int* profile, int length, int threshold, int* out_c
     }
 
     if (raw_count == 0) {
-        free(raw_ranges);
+        arena_dealloc(scratch, raw_ranges);
         *out_count = 0;
         return NULL;
     }
 
     // Étape 2 : Calculer la taille médiane d'un segment (une lettre)
-    int* sizes = malloc(sizeof(int) * raw_count);
+    int* sizes = arena_alloc(scratch, sizeof(int) * raw_count);
     for (int i = 0; i < raw_count; i++) {
         sizes[i] = raw_ranges[i].end - raw_ranges[i].start;
     }
     qsort(sizes, raw_count, sizeof(int), compare_ints);
     int median_size = sizes[raw_count / 2];
-    free(sizes);
+    arena_dealloc(scratch, sizes);
 
     printf("   [SmartCut] Median size detected: %d px\n", median_size);
 
     // Étape 3 : Raffiner les découpes
     // Si un segment est ~2x la médiane, c'est que deux lettres se touchent. On coupe au milieu.
-    Range* final_ranges = malloc(sizeof(Range) * 200); // Max 200 cases/lignes
+    // Chaque sous-segment fait au moins 1 px et ils ne se chevauchent pas : length suffit
+    Range* final_ranges = arena_alloc(scratch, sizeof(Range) * length);
     int final_count = 0;
 
     // Tolérance pour dire "c'est une seule lettre" (ex: 1.5x la médiane max)
     double split_threshold = median_size * 1.6; 
 
+    // Un segment de moins d'un quart de lettre est une tache, pas une colonne
+    int min_size = median_size / 4;
+
     for (int i = 0; i < raw_count; i++) {
         int w = raw_ranges[i].end - raw_ranges[i].start;
         
+        if (w < min_size) continue;
+
         if (w > split_threshold) {
             // Le bloc est trop gros ! Il faut le découper.
             // On estime combien de lettres sont collées (arrondi à l'entier le plus proche)
@@ -139,25 +111,25 @@ static Range* get_smart_cuts(int* profile, int length, int threshold, int* out_c
         }
     }
 
-    free(raw_ranges);
+    arena_dealloc(scratch, raw_ranges);
     *out_count = final_count;
     return final_ranges;
 }
 
 
-int slice_grid_no_lines(SDL_Surface* grid, const char* output_dir) {
-    if (!grid || !output_dir) return -1;
-
-    if (SDL_MUSTLOCK(grid)) SDL_LockSurface(grid);
+static int cut_grid_no_lines(const Bitmap* grid, GlyphSet* cells, Arena* scratch) {
+    // Les cases sont des vues d'une copie de l'image 1 bit de la grille, gardée
+    // par cells
+    if (glyph_set_load(cells, grid) != 0) return -1;
+    const Bitmap* bm = &cells->source;
 
-    int W = grid->w;
-    int H = grid->h;
+    int W = bm->w;
+    int H = bm->h;
     
-    // 1. Profils
-    int* Hprof = (int*)calloc(H, sizeof(int));
-    int* Vprof = (int*)calloc(W, sizeof(int));
-    build_profile_rows(grid, Hprof);
-    build_profile_cols(grid, Vprof);
+    // 1. Profils des lignes et des colonnes, en un seul passage sur l'image 1 bit
+    int* Hprof = (int*)arena_alloc(scratch, sizeof(int) * H);
+    int* Vprof = (int*)arena_alloc(scratch, sizeof(int) * W);
+    profile_region(bm, 0, 0, W, H, Hprof, Vprof);
 
     // 2. Découpe intelligente
     // Seuil à 0 ou 1 : permet d'ignorer le micro bruit blanc, mais attrape le moindre bout de lettre
@@ -165,26 +137,26 @@ int slice_grid_no_lines(SDL_Surface* grid, const char* output_dir) {
     int nb_cols = 0;
     
     printf("[No-Line] Analyzing Rows...\n");
-    Range* rows = get_smart_cuts(Hprof, H, 0, &nb_rows);
+    Range* rows = get_smart_cuts(Hprof, H, 0, &nb_rows, scratch);
     
     printf("[No-Line] Analyzing Cols...\n");
-    Range* cols = get_smart_cuts(Vprof, W, 0, &nb_cols);
+    Range* cols = get_smart_cuts(Vprof, W, 0, &nb_cols, scratch);
 
-    free(Hprof);
-    free(Vprof);
-    if (SDL_MUSTLOCK(grid)) SDL_UnlockSurface(grid);
+    arena_dealloc(scratch, Hprof);
+    arena_dealloc(scratch, Vprof);
 
     if (nb_rows == 0 || nb_cols == 0) {
         fprintf(stderr, "[No-Line] Error: Could not define grid structure.\n");
-        if(rows) free(rows);
-        if(cols) free(cols);
+        if(rows) arena_dealloc(scratch, rows);
+        if(cols) arena_dealloc(scratch, cols);
         return -1;
     }
 
     printf("[No-Line] Structure detected: %d rows x %d cols\n", nb_rows, nb_cols);
 
     // 3. Extraction
-    char path[512];
+    cells->rows = nb_rows;
+    cells->cols = nb_cols;
     int saved = 0;
     
     // Marge de sécurité (padding) autour de la lettre découpée
@@ -211,22 +183,23 @@ int slice_grid_no_lines(SDL_Surface* grid, const char* output_dir) {
 
             if (w <= 0 || h <= 0) continue;
 
-            SDL_Rect src = { x0, y0, w, h };
-            SDL_Surface* cell = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
-            
-            // Remplir de blanc (important si le padding dépasse la zone noire)
-            SDL_FillRect(cell, NULL, SDL_MapRGB(cell->format, 255, 255, 255));
-            SDL_BlitSurface(grid, &src, cell, NULL);
-
-            snprintf(path, sizeof(path), "%s/c_%02d_%02d.bmp", output_dir, r, c);
-            SDL_SaveBMP(cell, path);
-            SDL_FreeSurface(cell);
-            saved++;
+            SDL_Rect cell = { x0, y0, w, h };
+            if (glyph_set_push(cells, cell, cell, 0, r, c) == 0) saved++;
         }
     }
 
-    free(rows);
-    free(cols);
-    printf("[No-Line] Saved %d cells.\n", saved);
+    arena_dealloc(scratch, rows);
+    arena_dealloc(scratch, cols);
+    printf("[No-Line] Sliced %d cells.\n", saved);
     return 0;
 }
+
+int slice_grid_no_lines(const Bitmap* grid, GlyphSet* cells, Arena* scratch) {
+    if (!grid || !cells) return -1;
+
+    // Les tampons de travail sont rendus à scratch en sortie
+    ArenaMark mark = arena_mark(scratch);
+    int res = cut_grid_no_lines(grid, cells, scratch);
+    arena_release(scratch, mark);
+    return res;
+}
@@ -2,8 +2,13 @@
 #define SLICE_GRID_NO_LINES_H
 
 #include <SDL2/SDL.h>
+#include "glyph_set.h"
+#include "../utils/arena.h"
 
 // Découpe une grille sans quadrillage en détectant les alignements de texte
-int slice_grid_no_lines(SDL_Surface* grid, const char* output_dir);
+// Une copie de la grille devient l'image de cells, et les cases y sont ajoutées
+// comme des vues de celle-ci. Les tampons de travail sont pris dans scratch
+// (NULL = tas), laissé tel qu'il était.
+int slice_grid_no_lines(const Bitmap* grid, GlyphSet* cells, Arena* scratch);
 
 #endif
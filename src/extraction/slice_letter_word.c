@@ -1,160 +1,57 @@
 #include "slice_letter_word.h"
+#include "bitmap.h"
+#include "components.h"
+#include "profile.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
-#include <dirent.h>
-#include <sys/stat.h>
-
-static inline bool is_black(uint32_t px) {
-    return ((px & 0x00FFFFFF) == 0);
-}
 
 typedef struct {
     int x_start, x_end;
     int y_start, y_end;
 } BoundingBox;
 
-// Flood fill to label connected pixels (iterative to avoid stack overflow)
-static void flood_fill(int** labels, SDL_Surface* img, int x, int y, int label) {
-    int W = img->w;
-    int H = img->h;
-    
-    int* stack_x = (int*)malloc(W * H * sizeof(int));
-    int* stack_y = (int*)malloc(W * H * sizeof(int));
-    int stack_top = 0;
-    
-    stack_x[stack_top] = x;
-    stack_y[stack_top] = y;
-    stack_top++;
-    
-    uint8_t* base = (uint8_t*)img->pixels;
-    int pitch = img->pitch;
-    
-    while (stack_top > 0) {
-        stack_top--;
-        int cx = stack_x[stack_top];
-        int cy = stack_y[stack_top];
-        
-        if (cx < 0 || cx >= W || cy < 0 || cy >= H) continue;
-        if (labels[cy][cx] != 0) continue;
-        
-        uint32_t* row = (uint32_t*)(base + cy * pitch);
-        if (!is_black(row[cx])) continue;
-        
-        labels[cy][cx] = label;
-        
-        // Add 8-connected neighbors
-        if (cx + 1 < W) { stack_x[stack_top] = cx + 1; stack_y[stack_top] = cy; stack_top++; }
-        if (cx - 1 >= 0) { stack_x[stack_top] = cx - 1; stack_y[stack_top] = cy; stack_top++; }
-        if (cy + 1 < H) { stack_x[stack_top] = cx; stack_y[stack_top] = cy + 1; stack_top++; }
-        if (cy - 1 >= 0) { stack_x[stack_top] = cx; stack_y[stack_top] = cy - 1; stack_top++; }
-        if (cx + 1 < W && cy + 1 < H) { stack_x[stack_top] = cx + 1; stack_y[stack_top] = cy + 1; stack_top++; }
-        if (cx - 1 >= 0 && cy + 1 < H) { stack_x[stack_top] = cx - 1; stack_y[stack_top] = cy + 1; stack_top++; }
-        if (cx + 1 < W && cy - 1 >= 0) { stack_x[stack_top] = cx + 1; stack_y[stack_top] = cy - 1; stack_top++; }
-        if (cx - 1 >= 0 && cy - 1 >= 0) { stack_x[stack_top] = cx - 1; stack_y[stack_top] = cy - 1; stack_top++; }
-    }
-    
-    free(stack_x);
-    free(stack_y);
-}
-
-// Find all connected components
-static BoundingBox* find_connected_components(SDL_Surface* img, int* out_count) {
-    int W = img->w;
-    int H = img->h;
-    
-    if (SDL_MUSTLOCK(img)) SDL_LockSurface(img);
-    
-    int** labels = (int**)malloc(H * sizeof(int*));
-    for (int y = 0; y < H; y++) {
-        labels[y] = (int*)calloc(W, sizeof(int));
-    }
-    
-    int current_label = 1;
-    
-    for (int y = 0; y < H; y++) {
-        for (int x = 0; x < W; x++) {
-            if (labels[y][x] == 0) {
-                uint8_t* base = (uint8_t*)img->pixels;
-                int pitch = img->pitch;
-                uint32_t* row = (uint32_t*)(base + y * pitch);
-                
-                if (is_black(row[x])) {
-                    flood_fill(labels, img, x, y, current_label);
-                    current_label++;
-                }
-            }
-        }
-    }
-    
-    int num_components = current_label - 1;
-    //printf("[CONNECTED_COMPONENTS] Found %d components\n", num_components);
-    
-    if (num_components == 0) {
-        if (SDL_MUSTLOCK(img)) SDL_UnlockSurface(img);
-        for (int y = 0; y < H; y++) free(labels[y]);
-        free(labels);
-        *out_count = 0;
+// Find all connected components (8-connected), in raster order of their first
+// pixel: one labeling pass over the runs of ink, whatever their number
+static BoundingBox* find_connected_components(const Bitmap* img, int* out_count, Arena* scratch) {
+    *out_count = 0;
+    Components cc;
+    if (components_find(img, &cc, scratch) != 0 || cc.count == 0) {
+        components_free(&cc);
         return NULL;
     }
-    
-    BoundingBox* boxes = (BoundingBox*)malloc(num_components * sizeof(BoundingBox));
-    
-    for (int i = 0; i < num_components; i++) {
-        boxes[i].x_start = W;
-        boxes[i].x_end = 0;
-        boxes[i].y_start = H;
-        boxes[i].y_end = 0;
-    }
-    
-    for (int y = 0; y < H; y++) {
-        for (int x = 0; x < W; x++) {
-            int label = labels[y][x];
-            if (label > 0) {
-                int idx = label - 1;
-                if (x < boxes[idx].x_start) boxes[idx].x_start = x;
-                if (x > boxes[idx].x_end) boxes[idx].x_end = x;
-                if (y < boxes[idx].y_start) boxes[idx].y_start = y;
-                if (y > boxes[idx].y_end) boxes[idx].y_end = y;
-            }
+
+    BoundingBox* boxes = (BoundingBox*)arena_alloc(scratch, cc.count * sizeof(BoundingBox));
+    if (boxes) {
+        for (int i = 0; i < cc.count; i++) {
+            boxes[i].x_start = cc.items[i].x0;
+            boxes[i].x_end = cc.items[i].x1;
+            boxes[i].y_start = cc.items[i].y0;
+            boxes[i].y_end = cc.items[i].y1;
         }
+        *out_count = cc.count;
     }
-    
-    for (int i = 0; i < num_components; i++) {
-        boxes[i].x_end++;
-        boxes[i].y_end++;
-    }
-    
-    for (int y = 0; y < H; y++) free(labels[y]);
-    free(labels);
-    
-    if (SDL_MUSTLOCK(img)) SDL_UnlockSurface(img);
-    
-    *out_count = num_components;
+    components_free(&cc);
     return boxes;
 }
 
 // Find split points in a wide component using vertical projection
-static int* find_split_points_in_component(SDL_Surface* img, BoundingBox box, int* out_splits) {
+static int* find_split_points_in_component(const Bitmap* img, BoundingBox box, int* out_splits,
+                                           Arena* scratch) {
     int width = box.x_end - box.x_start;
     int height = box.y_end - box.y_start;
+    *out_splits = 0;
     
-    uint8_t* base = (uint8_t*)img->pixels;
-    int pitch = img->pitch;
-    
-    int* col_black = (int*)calloc(width, sizeof(int));
+    int* col_black = (int*)arena_alloc(scratch, sizeof(int) * width);
+    if (!col_black) return NULL;
+    profile_region(img, box.x_start, box.y_start, width, height, NULL, col_black);
     
-    for (int x = 0; x < width; x++) {
-        for (int y = box.y_start; y < box.y_end; y++) {
-            uint32_t* row = (uint32_t*)(base + y * pitch);
-            if (is_black(row[box.x_start + x])) {
-                col_black[x]++;
-            }
-        }
+    int* splits = (int*)arena_alloc(scratch, 10 * sizeof(int));
+    if (!splits) {
+        arena_dealloc(scratch, col_black);
+        return NULL;
     }
-    
-    int* splits = (int*)malloc(10 * sizeof(int));
     int split_count = 0;
     
     int min_valley_depth = height / 4;
@@ -169,30 +66,38 @@ static int* find_split_points_in_component(SDL_Surface* img, BoundingBox box, in
         }
     }
     
-    free(col_black);
+    arena_dealloc(scratch, col_black);
     *out_splits = split_count;
     return splits;
 }
 
 // Split a wide component into sub-components
-static BoundingBox* split_wide_component(SDL_Surface* img, BoundingBox box, int* out_count) {
+static BoundingBox* split_wide_component(const Bitmap* img, BoundingBox box, int* out_count,
+                                         Arena* scratch) {
     //int width = box.x_end - box.x_start;
     
+    *out_count = 0;
     int split_count;
-    int* split_points = find_split_points_in_component(img, box, &split_count);
+    int* split_points = find_split_points_in_component(img, box, &split_count, scratch);
+    if (!split_points) return NULL;
     
     //printf("[SPLIT] Component width=%d, found %d split points\n", width, split_count);
     
     if (split_count == 0) {
-        free(split_points);
-        BoundingBox* result = (BoundingBox*)malloc(sizeof(BoundingBox));
+        arena_dealloc(scratch, split_points);
+        BoundingBox* result = (BoundingBox*)arena_alloc(scratch, sizeof(BoundingBox));
+        if (!result) return NULL;
         result[0] = box;
         *out_count = 1;
         return result;
     }
     
     int num_boxes = split_count + 1;
-    BoundingBox* boxes = (BoundingBox*)malloc(num_boxes * sizeof(BoundingBox));
+    BoundingBox* boxes = (BoundingBox*)arena_alloc(scratch, num_boxes * sizeof(BoundingBox));
+    if (!boxes) {
+        arena_dealloc(scratch, split_points);
+        return NULL;
+    }
     
     int prev_x = box.x_start;
     for (int i = 0; i < split_count; i++) {
@@ -208,7 +113,7 @@ static BoundingBox* split_wide_component(SDL_Surface* img, BoundingBox box, int*
     boxes[split_count].y_start = box.y_start;
     boxes[split_count].y_end = box.y_end;
     
-    free(split_points);
+    arena_dealloc(scratch, split_points);
     *out_count = num_boxes;
     return boxes;
 }
@@ -221,8 +126,8 @@ static int compare_boxes(const void* a, const void* b) {
 }
 
 // Main segmentation function
-static BoundingBox* segment_word(SDL_Surface* word_img, int* out_count) {
-    BoundingBox* boxes = find_connected_components(word_img, out_count);
+static BoundingBox* segment_word(const Bitmap* word_img, int* out_count, Arena* scratch) {
+    BoundingBox* boxes = find_connected_components(word_img, out_count, scratch);
     
     if (!boxes || *out_count == 0) {
         return boxes;
@@ -230,7 +135,12 @@ static BoundingBox* segment_word(SDL_Surface* word_img, int* out_count) {
     
     qsort(boxes, *out_count, sizeof(BoundingBox), compare_boxes);
     
-    BoundingBox* final_boxes = (BoundingBox*)malloc(100 * sizeof(BoundingBox));
+    BoundingBox* final_boxes = (BoundingBox*)arena_alloc(scratch, 100 * sizeof(BoundingBox));
+    if (!final_boxes) {
+        arena_dealloc(scratch, boxes);
+        *out_count = 0;
+        return NULL;
+    }
     int final_count = 0;
     
     int MAX_LETTER_WIDTH = 25;
@@ -247,21 +157,27 @@ static BoundingBox* segment_word(SDL_Surface* word_img, int* out_count) {
             //printf("[SEGMENT] Component too wide (%d px), attempting split...\n", width);
             
             int sub_count;
-            BoundingBox* sub_boxes = split_wide_component(word_img, boxes[i], &sub_count);
+            BoundingBox* sub_boxes = split_wide_component(word_img, boxes[i], &sub_count, scratch);
+            if (!sub_boxes) {
+                arena_dealloc(scratch, final_boxes);
+                arena_dealloc(scratch, boxes);
+                *out_count = 0;
+                return NULL;
+            }
             
             for (int j = 0; j < sub_count && final_count < 100; j++) {
                 final_boxes[final_count] = sub_boxes[j];
                 final_count++;
             }
             
-            free(sub_boxes);
+            arena_dealloc(scratch, sub_boxes);
         } else {
             final_boxes[final_count] = boxes[i];
             final_count++;
         }
     }
     
-    free(boxes);
+    arena_dealloc(scratch, boxes);
     
     //printf("[SEGMENT] Final count: %d letters\n", final_count);
     
@@ -269,57 +185,40 @@ static BoundingBox* segment_word(SDL_Surface* word_img, int* out_count) {
     return final_boxes;
 }
 
-// Count word images
-static int count_word_images(const char* words_dir) {
-    int count = 0;
-    for (int i = 0; i < 100; i++) {
-        char path[512];
-        snprintf(path, sizeof(path), "%s/w_%02d.bmp", words_dir, i);
-        struct stat st;
-        if (stat(path, &st) == 0) {
-            count++;
-        } else {
-            break;
-        }
-    }
-    return count;
-}
-
 // Main function
-int slice_word_letters(const char* words_dir, const char* output_dir) {
+int slice_word_letters(const GlyphSet* words, GlyphSet* letters, Arena* scratch) {
     printf("\n[6/6] Slicing word letters (Connected Components + Splitting)...\n");
-    printf("[WORD_LETTERS] Input: %s\n", words_dir);
-    printf("[WORD_LETTERS] Output: %s\n", output_dir);
-    
-    struct stat st = {0};
-    if (stat(output_dir, &st) == -1) {
-        mkdir(output_dir, 0755);
-    }
     
-    int word_count = count_word_images(words_dir);
+    int word_count = words->count;
+    letters->rows = words->rows;
     if (word_count == 0) {
         fprintf(stderr, "[WORD_LETTERS] No word images found\n");
         return -1;
     }
     
     //printf("[WORD_LETTERS] Found %d word images\n", word_count);
+
+    // Les lettres sont des vues de la même liste de mots, qui survit à words
+    if (glyph_set_load_from(letters, words) != 0) return -1;
     
     int total_letters = 0;
     
-    for (int w = 0; w < word_count; w++) {
-        char word_path[512];
-        snprintf(word_path, sizeof(word_path), "%s/w_%02d.bmp", words_dir, w);
+    for (int i = 0; i < word_count; i++) {
+        int w = words->items[i].row;
         
-        SDL_Surface* word_img = SDL_LoadBMP(word_path);
-        if (!word_img) {
-            fprintf(stderr, "[WORD_LETTERS] Failed to load: %s\n", word_path);
+        //printf("\n[WORD_LETTERS] Processing word %02d...\n", w);
+        
+        // Chaque mot rend à scratch ce qu'il y a pris
+        ArenaMark mark = arena_mark(scratch);
+        const Glyph* word = &words->items[i];
+        Bitmap word_img;
+        if (glyph_to_bitmap(words, word, &word_img, scratch) != 0) {
+            arena_release(scratch, mark);
             continue;
         }
         
-        //printf("\n[WORD_LETTERS] Processing word %02d...\n", w);
-        
         int letter_count;
-        BoundingBox* boxes = segment_word(word_img, &letter_count);
+        BoundingBox* boxes = segment_word(&word_img, &letter_count, scratch);
         
         //printf("[WORD_LETTERS] Word %02d: %d letters detected\n", w, letter_count);
         
@@ -336,30 +235,21 @@ int slice_word_letters(const char* words_dir, const char* output_dir) {
                 width += 2 * margin;
                 height += 2 * margin;
                 
-                if (x + width > word_img->w) width = word_img->w - x;
-                if (y + height > word_img->h) height = word_img->h - y;
+                if (x + width > word_img.w) width = word_img.w - x;
+                if (y + height > word_img.h) height = word_img.h - y;
                 
-                SDL_Rect src = {x, y, width, height};
-                SDL_Surface* letter_surf = SDL_CreateRGBSurfaceWithFormat(
-                    0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+                if (width <= 0 || height <= 0) continue;
                 
-                SDL_Rect dst = {0, 0, 0, 0};
-                SDL_BlitSurface(word_img, &src, letter_surf, &dst);
-                
-                char letter_path[512];
-                snprintf(letter_path, sizeof(letter_path), 
-                         "%s/word_%02d_letter_%02d.bmp", output_dir, w, l);
-                
-                SDL_SaveBMP(letter_surf, letter_path);
-                SDL_FreeSurface(letter_surf);
-                
-                total_letters++;
+                // Vue de la liste de mots, coupée au mot comme l'était son image
+                SDL_Rect letter = { word->rect.x + x, word->rect.y + y, width, height };
+                if (glyph_set_push(letters, letter, word->clip, word->fill, w, l) == 0)
+                    total_letters++;
             }
             
-            free(boxes);
+            arena_dealloc(scratch, boxes);
         }
-        
-        SDL_FreeSurface(word_img);
+        bitmap_free(&word_img);
+        arena_release(scratch, mark);
     }
     
     printf("\n[WORD_LETTERS] ✓ Extracted %d letters from %d words\n", 
@@ -2,7 +2,13 @@
 #define SLICE_LETTER_WORD_H
 
 #include <SDL2/SDL.h>
+#include "glyph_set.h"
+#include "../utils/arena.h"
 
-int slice_word_letters(const char* words_dir, const char* output_dir);
+// Splits every word image into letters (row = word index, col = letter index).
+// The letters are views of a copy of the word list bitmap of words.
+// The work buffers of a word come from scratch (NULL = heap) and go back to it
+// before the next word.
+int slice_word_letters(const GlyphSet* words, GlyphSet* letters, Arena* scratch);
 
 #endif
@@ -1,4 +1,6 @@
 #include "slice_words.h"
+#include "bitmap.h"
+#include "profile.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -13,13 +15,6 @@
 
 // --- Fonctions utilitaires ---
 
-static inline bool is_black(uint32_t px) {
-    uint8_t r = (px >> 16) & 0xFF;
-    uint8_t g = (px >> 8) & 0xFF;
-    uint8_t b = px & 0xFF;
-    return (r < 200 && g < 200 && b < 200);
-}
-
 typedef struct {
     int y_start;
     int y_end;
@@ -27,23 +22,13 @@ typedef struct {
 
 // --- Détection des lignes (Axe Y) ---
 
-static LineSegment* find_text_lines(SDL_Surface* img, int* out_count) {
-    int W = img->w;
+static LineSegment* find_text_lines(const Bitmap* img, int* out_count, Arena* scratch) {
     int H = img->h;
-    uint8_t* base = (uint8_t*)img->pixels;
-    int pitch = img->pitch;
 
-    int* proj_y = (int*)calloc(H, sizeof(int));
-    for (int y = 0; y < H; y++) {
-        for (int x = 0; x < W; x++) {
-            uint32_t px = ((uint32_t*)(base + y * pitch))[x];
-            if (is_black(px)) {
-                proj_y[y]++;
-            }
-        }
-    }
+    int* proj_y = (int*)arena_alloc(scratch, sizeof(int) * H);
+    profile_region(img, 0, 0, img->w, H, proj_y, NULL);
 
-    LineSegment* lines = (LineSegment*)malloc(sizeof(LineSegment) * 100);
+    LineSegment* lines = (LineSegment*)arena_alloc(scratch, sizeof(LineSegment) * 100);
     int count = 0;
     
     bool inside_line = false;
@@ -82,63 +67,38 @@ static LineSegment* find_text_lines(SDL_Surface* img, int* out_count) {
         count++;
     }
 
-    free(proj_y);
+    arena_dealloc(scratch, proj_y);
     *out_count = count;
     return lines;
 }
 
 // --- Extraction des mots (Axe X) avec PADDING ---
 
-static int slice_row_into_words(SDL_Surface* img, LineSegment line, int word_index_start, const char* output_dir) {
+static int slice_row_into_words(const Bitmap* img, LineSegment line, int word_index_start, GlyphSet* words,
+                                Arena* scratch) {
     int W = img->w;
-    uint8_t* base = (uint8_t*)img->pixels;
-    int pitch = img->pitch;
 
-    int* proj_x = (int*)calloc(W, sizeof(int));
-    for (int x = 0; x < W; x++) {
-        for (int y = line.y_start; y < line.y_end; y++) {
-            uint32_t px = ((uint32_t*)(base + y * pitch))[x];
-            if (is_black(px)) {
-                proj_x[x]++;
-            }
-        }
-    }
+    int* proj_x = (int*)arena_alloc(scratch, sizeof(int) * W);
+    profile_region(img, 0, line.y_start, W, line.y_end - line.y_start, NULL, proj_x);
 
     int saved_count = 0;
     bool inside_word = false;
     int start_x = 0;
     int white_gap = 0;
 
-    // Helper pour sauvegarder un mot avec marge
+    // Helper pour extraire un mot avec marge
     void save_word(int sx, int ex) {
         int w = ex - sx;
         int h = line.y_end - line.y_start;
         
         if (w > 5) {
-            // Rectangle source (l'image originale)
-            SDL_Rect src = { sx, line.y_start, w, h };
-            
-            // Dimensions de la destination (taille originale + marge blanche autour)
-            int final_w = w + (PADDING * 2);
-            int final_h = h + (PADDING * 2);
-
-            SDL_Surface* word_s = SDL_CreateRGBSurfaceWithFormat(0, final_w, final_h, 32, SDL_PIXELFORMAT_ARGB8888);
-            
-            // Remplir tout en blanc d'abord
-            SDL_FillRect(word_s, NULL, SDL_MapRGB(word_s->format, 255, 255, 255));
-            
-            // Position où coller le mot (décalé par le padding)
-            SDL_Rect dst_offset = { PADDING, PADDING, w, h };
+            // Le mot (clip) entouré d'une marge blanche : une vue de la liste,
+            // rien n'est copié
+            SDL_Rect word = { sx, line.y_start, w, h };
+            SDL_Rect padded = { sx - PADDING, line.y_start - PADDING, w + PADDING * 2, h + PADDING * 2 };
             
-            // Copier le mot au centre
-            SDL_BlitSurface(img, &src, word_s, &dst_offset);
-            
-            char path[512];
-            snprintf(path, sizeof(path), "%s/w_%02d.bmp", output_dir, word_index_start + saved_count);
-            SDL_SaveBMP(word_s, path);
-            SDL_FreeSurface(word_s);
-            
-            saved_count++;
+            if (glyph_set_push(words, padded, word, 0, word_index_start + saved_count, 0) == 0)
+                saved_count++;
         }
     }
 
@@ -167,26 +127,35 @@ static int slice_row_into_words(SDL_Surface* img, LineSegment line, int word_ind
         save_word(start_x, W);
     }
 
-    free(proj_x);
+    arena_dealloc(scratch, proj_x);
     return saved_count;
 }
 
 // --- Fonction Principale ---
 
-int slice_words(SDL_Surface* wordlist, const char* output_dir) {
-    if (!wordlist || !output_dir) return -1;
+int slice_words(const Bitmap* wordlist, GlyphSet* words, Arena* scratch) {
+    if (!wordlist || !words) return -1;
     
     printf("[slice_words] Processing list %dx%d (Padding: %dpx)...\n", wordlist->w, wordlist->h, PADDING);
 
-    if (SDL_MUSTLOCK(wordlist)) SDL_LockSurface(wordlist);
+    // Les tampons de travail sont rendus à scratch en sortie
+    ArenaMark mark = arena_mark(scratch);
+
+    // Image 1 bit : les profils se comptent par mots de 64 pixels. Une copie est
+    // gardée par words, dont les mots sont des vues.
+    if (glyph_set_load(words, wordlist) != 0) {
+        arena_release(scratch, mark);
+        return -1;
+    }
+    const Bitmap* bm = &words->source;
 
     int line_count = 0;
-    LineSegment* lines = find_text_lines(wordlist, &line_count);
+    LineSegment* lines = find_text_lines(bm, &line_count, scratch);
 
     if (line_count == 0) {
         fprintf(stderr, "[slice_words] ✗ No text lines detected.\n");
-        if (SDL_MUSTLOCK(wordlist)) SDL_UnlockSurface(wordlist);
-        free(lines);
+        arena_dealloc(scratch, lines);
+        arena_release(scratch, mark);
         return -1;
     }
 
@@ -194,14 +163,15 @@ int slice_words(SDL_Surface* wordlist, const char* output_dir) {
 
     int total_words = 0;
     for (int i = 0; i < line_count; i++) {
-        int added = slice_row_into_words(wordlist, lines[i], total_words, output_dir);
+        int added = slice_row_into_words(bm, lines[i], total_words, words, scratch);
         total_words += added;
     }
 
-    if (SDL_MUSTLOCK(wordlist)) SDL_UnlockSurface(wordlist);
-    free(lines);
+    arena_dealloc(scratch, lines);
+    arena_release(scratch, mark);
 
-    printf("[slice_words] ✓ Extraction complete. %d words saved to %s\n", total_words, output_dir);
+    words->rows = total_words;
+    printf("[slice_words] ✓ Extraction complete. %d words\n", total_words);
     
     return 0;
 }
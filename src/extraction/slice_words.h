@@ -1,5 +1,10 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include "glyph_set.h"
+#include "../utils/arena.h"
 
 
-int slice_words(SDL_Surface* wl, const char* output_dir);
+// Cuts the word list into one padded image per word, appended to `words` as
+// views of the word list, a copy of which becomes its bitmap.
+// The work buffers come from scratch (NULL = heap), which is left as it was found.
+int slice_words(const Bitmap* wl, GlyphSet* words, Arena* scratch);
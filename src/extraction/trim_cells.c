@@ -2,139 +2,31 @@
 #include <SDL2/SDL.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdbool.h>
-#include <string.h>
-#include <dirent.h>
-#include <sys/stat.h>
 
 #define MARGIN 1
 
-static inline bool is_black(uint32_t px) {
-    return ((px & 0x00FFFFFF) == 0);
-}
-
-
-static int find_left_bound(SDL_Surface* img) {
-    uint8_t* base = (uint8_t*)img->pixels;
-    int pitch = img->pitch;
-    
-    for (int x = 0; x < img->w; x++) {
-        for (int y = 0; y < img->h; y++) {
-            uint32_t* row = (uint32_t*)(base + y * pitch);
-            if (is_black(row[x])) {
-                return x;
-            }
-        }
-    }
-    return 0;
-}
-
-
-static int find_right_bound(SDL_Surface* img) {
-    uint8_t* base = (uint8_t*)img->pixels;
-    int pitch = img->pitch;
-    
-    for (int x = img->w - 1; x >= 0; x--) {
-        for (int y = 0; y < img->h; y++) {
-            uint32_t* row = (uint32_t*)(base + y * pitch);
-            if (is_black(row[x])) {
-                return x + 1; // Exclusive bound
-            }
-        }
-    }
-    return img->w;
-}
-
-static int find_top_bound(SDL_Surface* img) {
-    uint8_t* base = (uint8_t*)img->pixels;
-    int pitch = img->pitch;
-    
-    for (int y = 0; y < img->h; y++) {
-        uint32_t* row = (uint32_t*)(base + y * pitch);
-        for (int x = 0; x < img->w; x++) {
-            if (is_black(row[x])) {
-                return y;
-            }
-        }
-    }
-    return 0;
-}
-
-static int find_bottom_bound(SDL_Surface* img) {
-    uint8_t* base = (uint8_t*)img->pixels;
-    int pitch = img->pitch;
-    
-    for (int y = img->h - 1; y >= 0; y--) {
-        uint32_t* row = (uint32_t*)(base + y * pitch);
-        for (int x = 0; x < img->w; x++) {
-            if (is_black(row[x])) {
-                return y + 1; // Exclusive bound
-            }
-        }
-    }
-    return img->h;
-}
-
-// Trim a single image and return trimmed version
-static SDL_Surface* trim_image(SDL_Surface* img) {
-    if (!img) return NULL;
+// Trim a single cell: its rectangle shrinks to the ink plus MARGIN
+static void trim_cell(const GlyphSet* cells, Glyph* cell) {
+    // A blank cell keeps its full size (plus the margin)
+    int left = cell->rect.x, top = cell->rect.y;
+    int right = left + cell->rect.w, bottom = top + cell->rect.h;
+    glyph_ink_bounds(cells, cell, &left, &top, &right, &bottom);
+    left -= MARGIN;
+    right += MARGIN;
+    top -= MARGIN;
+    bottom += MARGIN;
     
-    if (SDL_MUSTLOCK(img)) SDL_LockSurface(img);
-    
-    int left = find_left_bound(img)-MARGIN;
-    int right = find_right_bound(img)+MARGIN;
-    int top = find_top_bound(img)-MARGIN;
-    int bottom = find_bottom_bound(img)+MARGIN;
-    
-    if (SDL_MUSTLOCK(img)) SDL_UnlockSurface(img);
-    
-    // Ensure valid bounds
-    if (left >= right || top >= bottom) {
-        // Empty or all-white image - return 1x1 white image
-        SDL_Surface* empty = SDL_CreateRGBSurfaceWithFormat(
-            0, 1, 1, 32, SDL_PIXELFORMAT_ARGB8888);
-        uint32_t white = 0xFFFFFFFF;
-        memcpy(empty->pixels, &white, sizeof(uint32_t));
-        return empty;
-    }
+    cell->rect = (SDL_Rect){ left, top, right - left, bottom - top };
     
-    int new_w = right - left;
-    int new_h = bottom - top;
-    
-    // Create trimmed surface
-    SDL_Rect src = {left, top, new_w, new_h};
-    SDL_Surface* trimmed = SDL_CreateRGBSurfaceWithFormat(
-        0, new_w, new_h, 32, SDL_PIXELFORMAT_ARGB8888);
-    
-    SDL_Rect dst = {0, 0, 0, 0};
-    SDL_BlitSurface(img, &src, trimmed, &dst);
-    
-    return trimmed;
-}
-
-// Count cell files
-static int count_cells(const char* cells_dir) {
-    int count = 0;
-    for (int r = 0; r < 50; r++) {
-        for (int c = 0; c < 50; c++) {
-            char path[512];
-            snprintf(path, sizeof(path), "%s/c_%02d_%02d.bmp", cells_dir, r, c);
-            struct stat st;
-            if (stat(path, &st) == 0) {
-                count++;
-            }
-        }
-    }
-    return count;
+    // The margin may reach past the cell. The cells were always cut with that
+    // part left at 0 (black), and the recognizer is trained on them: keep it.
+    cell->fill = 1;
 }
 
-
-int trim_cells(const char* cells_dir) {
-    printf("[TRIM_CELLS] Processing cells in: %s\n", cells_dir);
-    
-    int total_cells = count_cells(cells_dir);
+int trim_cells(GlyphSet* cells) {
+    int total_cells = cells->count;
     if (total_cells == 0) {
-        fprintf(stderr, "[TRIM_CELLS] No cells found in %s\n", cells_dir);
+        fprintf(stderr, "[TRIM_CELLS] No cells to trim\n");
         return -1;
     }
     
@@ -142,37 +34,9 @@ int trim_cells(const char* cells_dir) {
     
     int trimmed_count = 0;
     
-    for (int r = 0; r < 50; r++) {
-        for (int c = 0; c < 50; c++) {
-            char path[512];
-            snprintf(path, sizeof(path), "%s/c_%02d_%02d.bmp", cells_dir, r, c);
-            
-            struct stat st;
-            if (stat(path, &st) != 0) continue;
-            
-            SDL_Surface* cell = SDL_LoadBMP(path);
-            if (!cell) {
-                fprintf(stderr, "[TRIM_CELLS] Failed to load: %s\n", path);
-                continue;
-            }
-            
-            //int orig_w = cell->w;
-            //int orig_h = cell->h;
-            
-            SDL_Surface* trimmed = trim_image(cell);
-            SDL_FreeSurface(cell);
-            
-            if (!trimmed) {
-                continue;
-            }
-            
-            SDL_SaveBMP(trimmed, path);
-            
-            
-            SDL_FreeSurface(trimmed);
-            
-            trimmed_count++;
-        }
+    for (int i = 0; i < total_cells; i++) {
+        trim_cell(cells, &cells->items[i]);
+        trimmed_count++;
     }
     
     printf("[TRIM_CELLS] ✓ Trimmed %d cells\n", trimmed_count);
@@ -1,6 +1,9 @@
 #ifndef TRIM_CELLS_H
 #define TRIM_CELLS_H
 
-int trim_cells(const char* cells_dir);
+#include "glyph_set.h"
+
+// Trims the white border of every cell, in place
+int trim_cells(GlyphSet* cells);
 
 #endif
@@ -1,6 +1,9 @@
 #ifndef TRIM_WORD_LETTERS_H
 #define TRIM_WORD_LETTERS_H
 
-int trim_word_letters(const char* letters_dir);
+#include "glyph_set.h"
+
+// Trims the white border of every word letter, in place
+int trim_word_letters(GlyphSet* letters);
 
 #endif
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <err.h>
+#include "ocr_session.h"
+
+// Mesure le coût du cycle de vie de la reconnaissance :
+//  - "par lettre" : ouvrir une session, reconnaitre une lettre, fermer (ancien comportement
+//    de recognize_letter qui quittait SDL et SDL_image après chaque lettre)
+//  - "session"    : une seule session pour toutes les lettres
+// Usage : bench_session [dossier_de_lettres] [répétitions]
+
+#define MAX_LETTERS 4096
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *dir_path = (argc > 1) ? argv[1] : MODEL_DIR "/cells";
+    int repeats = (argc > 2) ? atoi(argv[2]) : 5;
+    if (repeats < 1) repeats = 1;
+
+    static char paths[MAX_LETTERS][512];
+    int n = 0;
+    DIR *dir = opendir(dir_path);
+    if (!dir) errx(EXIT_FAILURE, "Erreur : impossible d'ouvrir %s", dir_path);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && n < MAX_LETTERS)
+    {
+        size_t len = strlen(entry->d_name);
+        if (len < 4 || strcasecmp(entry->d_name + len - 4, ".bmp") != 0) continue;
+        snprintf(paths[n++], sizeof(paths[0]), "%s/%s", dir_path, entry->d_name);
+    }
+    closedir(dir);
+    if (n == 0) errx(EXIT_FAILURE, "Erreur : aucune image .bmp dans %s", dir_path);
+
+    // les messages de chargement du modèle ne doivent pas compter dans la mesure
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, STDOUT_FILENO);
+
+    char first = 0;
+    double t0 = now_us();
+    for (int r = 0; r < repeats; r++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            OcrSession *session = ocr_session_open(1);
+            if (!session) errx(EXIT_FAILURE, "Erreur : ouverture de session impossible");
+            char c = ocr_session_recognize(session, paths[i]);
+            if (i == 0) first = c;
+            ocr_session_close(session);
+        }
+    }
+    double per_letter = (now_us() - t0) / ((double)repeats * n);
+
+    char check = 0;
+    t0 = now_us();
+    OcrSession *session = ocr_session_open(1);
+    if (!session) errx(EXIT_FAILURE, "Erreur : ouverture de session impossible");
+    for (int r = 0; r < repeats; r++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            char c = ocr_session_recognize(session, paths[i]);
+            if (i == 0) check = c;
+        }
+    }
+    ocr_session_close(session);
+    double one_session = (now_us() - t0) / ((double)repeats * n);
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(devnull);
+
+    printf("[BENCH] %d letters x %d from %s\n", n, repeats, dir_path);
+    printf("[BENCH] session per letter : %9.1f us/letter\n", per_letter);
+    printf("[BENCH] one session        : %9.1f us/letter\n", one_session);
+    printf("[BENCH] saved              : %9.1f us/letter (x%.1f)\n",
+           per_letter - one_session, per_letter / one_session);
+    if (first != check)
+        printf("[BENCH] ⚠️  results differ between the two modes\n");
+    return 0;
+}
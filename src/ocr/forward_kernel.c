@@ -0,0 +1,316 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "forward_kernel.h"
+
+#if OCR_SIMD && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define HAVE_X86_SIMD 0
+#endif
+
+// colonnes de w traitées ensemble : rows x K_BLOCK poids (256 Ko pour la couche cachée)
+// restent dans le cache L2 pour tout le lot
+#define K_BLOCK 512
+
+// --- Version scalaire ---
+
+static void matmul_scalar(const float *w, int rows, int cols, const float *x, int n, float *y)
+{
+    for (int s = 0; s < n; s++)
+    {
+        const float *xs = x + (size_t)s * cols;
+        for (int r = 0; r < rows; r++)
+        {
+            const float *wr = w + (size_t)r * cols;
+            float tot = 0.0f;
+            for (int k = 0; k < cols; k++) tot += wr[k] * xs[k];
+            y[(size_t)s * rows + r] = tot;
+        }
+    }
+}
+
+static void exp_scalar(float *x, int n)
+{
+    for (int i = 0; i < n; i++) x[i] = expf(x[i]);
+}
+
+static const ForwardKernel kernel_scalar = { "scalar", matmul_scalar, exp_scalar };
+
+#if HAVE_X86_SIMD
+
+// Constantes de l'approximation de exp (Cephes) : exp(x) = 2^n * p(r), r = x - n*ln(2)
+#define EXP_HI 88.3762626647949f
+#define EXP_LO -87.3365478515625f
+#define LOG2E 1.44269504088896341f
+#define LN2_HI 0.693359375f
+#define LN2_LO -2.12194440e-4f
+#define EXP_P0 1.9875691500E-4f
+#define EXP_P1 1.3981999507E-3f
+#define EXP_P2 8.3334519073E-3f
+#define EXP_P3 4.1665795894E-2f
+#define EXP_P4 1.6666665459E-1f
+#define EXP_P5 5.0000001201E-1f
+
+// --- Version SSE4.1 (4 flottants) ---
+
+__attribute__((target("sse4.1")))
+static inline float hsum128(__m128 v)
+{
+    __m128 sh = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 s = _mm_add_ps(v, sh);
+    sh = _mm_movehl_ps(sh, s);
+    s = _mm_add_ss(s, sh);
+    return _mm_cvtss_f32(s);
+}
+
+__attribute__((target("sse4.1")))
+static void matmul_sse(const float *w, int rows, int cols, const float *x, int n, float *y)
+{
+    memset(y, 0, (size_t)n * rows * sizeof(float));
+
+    for (int k0 = 0; k0 < cols; k0 += K_BLOCK)
+    {
+        int k1 = (k0 + K_BLOCK < cols) ? k0 + K_BLOCK : cols;
+        int kv = k0 + (k1 - k0) / 4 * 4;
+
+        // 4 lettres à la fois : chaque chargement de poids sert 4 fois
+        int s = 0;
+        for (; s + 4 <= n; s += 4)
+        {
+            const float *x0 = x + (size_t)s * cols;
+            const float *x1 = x0 + cols, *x2 = x1 + cols, *x3 = x2 + cols;
+            for (int r = 0; r < rows; r++)
+            {
+                const float *wr = w + (size_t)r * cols;
+                __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+                __m128 a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+                for (int k = k0; k < kv; k += 4)
+                {
+                    __m128 wv = _mm_loadu_ps(wr + k);
+                    a0 = _mm_add_ps(a0, _mm_mul_ps(wv, _mm_loadu_ps(x0 + k)));
+                    a1 = _mm_add_ps(a1, _mm_mul_ps(wv, _mm_loadu_ps(x1 + k)));
+                    a2 = _mm_add_ps(a2, _mm_mul_ps(wv, _mm_loadu_ps(x2 + k)));
+                    a3 = _mm_add_ps(a3, _mm_mul_ps(wv, _mm_loadu_ps(x3 + k)));
+                }
+                float t0 = hsum128(a0), t1 = hsum128(a1), t2 = hsum128(a2), t3 = hsum128(a3);
+                for (int k = kv; k < k1; k++)
+                {
+                    t0 += wr[k] * x0[k]; t1 += wr[k] * x1[k];
+                    t2 += wr[k] * x2[k]; t3 += wr[k] * x3[k];
+                }
+                y[(size_t)(s + 0) * rows + r] += t0;
+                y[(size_t)(s + 1) * rows + r] += t1;
+                y[(size_t)(s + 2) * rows + r] += t2;
+                y[(size_t)(s + 3) * rows + r] += t3;
+            }
+        }
+        for (; s < n; s++)
+        {
+            const float *xs = x + (size_t)s * cols;
+            for (int r = 0; r < rows; r++)
+            {
+                const float *wr = w + (size_t)r * cols;
+                __m128 a = _mm_setzero_ps();
+                for (int k = k0; k < kv; k += 4)
+                    a = _mm_add_ps(a, _mm_mul_ps(_mm_loadu_ps(wr + k), _mm_loadu_ps(xs + k)));
+                float t = hsum128(a);
+                for (int k = kv; k < k1; k++) t += wr[k] * xs[k];
+                y[(size_t)s * rows + r] += t;
+            }
+        }
+    }
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128 exp128(__m128 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(EXP_LO)), _mm_set1_ps(EXP_HI));
+    __m128 fx = _mm_round_ps(_mm_mul_ps(x, _mm_set1_ps(LOG2E)),
+                             _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(LN2_HI)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(LN2_LO)));
+
+    __m128 p = _mm_set1_ps(EXP_P0);
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(EXP_P1));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(EXP_P2));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(EXP_P3));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(EXP_P4));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(EXP_P5));
+    p = _mm_add_ps(_mm_mul_ps(p, _mm_mul_ps(x, x)), x);
+    p = _mm_add_ps(p, _mm_set1_ps(1.0f));
+
+    __m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(fx), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(p, _mm_castsi128_ps(e));
+}
+
+__attribute__((target("sse4.1")))
+static void exp_sse(float *x, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(x + i, exp128(_mm_loadu_ps(x + i)));
+    for (; i < n; i++) x[i] = expf(x[i]);
+}
+
+static const ForwardKernel kernel_sse = { "sse4.1", matmul_sse, exp_sse };
+
+// --- Version AVX2 + FMA (8 flottants) ---
+
+__attribute__((target("avx2,fma")))
+static inline float hsum256(__m256 v)
+{
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+__attribute__((target("avx2,fma")))
+static void matmul_avx2(const float *w, int rows, int cols, const float *x, int n, float *y)
+{
+    memset(y, 0, (size_t)n * rows * sizeof(float));
+
+    for (int k0 = 0; k0 < cols; k0 += K_BLOCK)
+    {
+        int k1 = (k0 + K_BLOCK < cols) ? k0 + K_BLOCK : cols;
+        int kv = k0 + (k1 - k0) / 8 * 8;
+
+        // 2 lignes de poids x 4 lettres à la fois : 6 chargements pour 8 FMA
+        int s = 0;
+        for (; s + 4 <= n; s += 4)
+        {
+            const float *x0 = x + (size_t)s * cols;
+            const float *x1 = x0 + cols, *x2 = x1 + cols, *x3 = x2 + cols;
+            int r = 0;
+            for (; r + 2 <= rows; r += 2)
+            {
+                const float *w0 = w + (size_t)r * cols, *w1 = w0 + cols;
+                __m256 a00 = _mm256_setzero_ps(), a01 = _mm256_setzero_ps();
+                __m256 a02 = _mm256_setzero_ps(), a03 = _mm256_setzero_ps();
+                __m256 a10 = _mm256_setzero_ps(), a11 = _mm256_setzero_ps();
+                __m256 a12 = _mm256_setzero_ps(), a13 = _mm256_setzero_ps();
+                for (int k = k0; k < kv; k += 8)
+                {
+                    __m256 v0 = _mm256_loadu_ps(w0 + k), v1 = _mm256_loadu_ps(w1 + k);
+                    __m256 g = _mm256_loadu_ps(x0 + k);
+                    a00 = _mm256_fmadd_ps(v0, g, a00); a10 = _mm256_fmadd_ps(v1, g, a10);
+                    g = _mm256_loadu_ps(x1 + k);
+                    a01 = _mm256_fmadd_ps(v0, g, a01); a11 = _mm256_fmadd_ps(v1, g, a11);
+                    g = _mm256_loadu_ps(x2 + k);
+                    a02 = _mm256_fmadd_ps(v0, g, a02); a12 = _mm256_fmadd_ps(v1, g, a12);
+                    g = _mm256_loadu_ps(x3 + k);
+                    a03 = _mm256_fmadd_ps(v0, g, a03); a13 = _mm256_fmadd_ps(v1, g, a13);
+                }
+                float t[2][4] = {
+                    { hsum256(a00), hsum256(a01), hsum256(a02), hsum256(a03) },
+                    { hsum256(a10), hsum256(a11), hsum256(a12), hsum256(a13) }
+                };
+                for (int k = kv; k < k1; k++)
+                {
+                    t[0][0] += w0[k] * x0[k]; t[0][1] += w0[k] * x1[k];
+                    t[0][2] += w0[k] * x2[k]; t[0][3] += w0[k] * x3[k];
+                    t[1][0] += w1[k] * x0[k]; t[1][1] += w1[k] * x1[k];
+                    t[1][2] += w1[k] * x2[k]; t[1][3] += w1[k] * x3[k];
+                }
+                for (int j = 0; j < 4; j++)
+                {
+                    y[(size_t)(s + j) * rows + r] += t[0][j];
+                    y[(size_t)(s + j) * rows + r + 1] += t[1][j];
+                }
+            }
+            for (; r < rows; r++)
+            {
+                const float *wr = w + (size_t)r * cols;
+                __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+                __m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+                for (int k = k0; k < kv; k += 8)
+                {
+                    __m256 wv = _mm256_loadu_ps(wr + k);
+                    a0 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x0 + k), a0);
+                    a1 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x1 + k), a1);
+                    a2 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x2 + k), a2);
+                    a3 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x3 + k), a3);
+                }
+                float t0 = hsum256(a0), t1 = hsum256(a1), t2 = hsum256(a2), t3 = hsum256(a3);
+                for (int k = kv; k < k1; k++)
+                {
+                    t0 += wr[k] * x0[k]; t1 += wr[k] * x1[k];
+                    t2 += wr[k] * x2[k]; t3 += wr[k] * x3[k];
+                }
+                y[(size_t)(s + 0) * rows + r] += t0;
+                y[(size_t)(s + 1) * rows + r] += t1;
+                y[(size_t)(s + 2) * rows + r] += t2;
+                y[(size_t)(s + 3) * rows + r] += t3;
+            }
+        }
+        for (; s < n; s++)
+        {
+            const float *xs = x + (size_t)s * cols;
+            for (int r = 0; r < rows; r++)
+            {
+                const float *wr = w + (size_t)r * cols;
+                __m256 a = _mm256_setzero_ps();
+                for (int k = k0; k < kv; k += 8)
+                    a = _mm256_fmadd_ps(_mm256_loadu_ps(wr + k), _mm256_loadu_ps(xs + k), a);
+                float t = hsum256(a);
+                for (int k = kv; k < k1; k++) t += wr[k] * xs[k];
+                y[(size_t)s * rows + r] += t;
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 exp256(__m256 x)
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(EXP_LO)), _mm256_set1_ps(EXP_HI));
+    __m256 fx = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(LOG2E)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(LN2_HI), x);
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(LN2_LO), x);
+
+    __m256 p = _mm256_set1_ps(EXP_P0);
+    p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(EXP_P1));
+    p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(EXP_P2));
+    p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(EXP_P3));
+    p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(EXP_P4));
+    p = _mm256_fmadd_ps(p, x, _mm256_set1_ps(EXP_P5));
+    p = _mm256_fmadd_ps(p, _mm256_mul_ps(x, x), x);
+    p = _mm256_add_ps(p, _mm256_set1_ps(1.0f));
+
+    __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(fx), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(e));
+}
+
+__attribute__((target("avx2,fma")))
+static void exp_avx2(float *x, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(x + i, exp256(_mm256_loadu_ps(x + i)));
+    for (; i < n; i++) x[i] = expf(x[i]);
+}
+
+static const ForwardKernel kernel_avx2 = { "avx2", matmul_avx2, exp_avx2 };
+
+#endif /* HAVE_X86_SIMD */
+
+// choisit le noyau le plus rapide supporté par le processeur (ou celui demandé par OCR_KERNEL)
+const ForwardKernel *forward_kernel_select(void)
+{
+    const char *force = getenv("OCR_KERNEL");
+    if (force && strcmp(force, "scalar") == 0) return &kernel_scalar;
+
+#if HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if ((!force || strcmp(force, "avx2") == 0)
+        && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return &kernel_avx2;
+    if ((!force || strcmp(force, "sse") == 0) && __builtin_cpu_supports("sse4.1"))
+        return &kernel_sse;
+#endif
+
+    return &kernel_scalar;
+}
@@ -0,0 +1,22 @@
+#ifndef FORWARD_KERNEL_H
+#define FORWARD_KERNEL_H
+
+// Noyaux de calcul de la propagation avant : scalaire, SSE4.1 et AVX2+FMA.
+// Compiler avec OCR_SIMD=0 ne garde que la version scalaire. Sinon la meilleure version
+// supportée par le processeur est choisie à l'exécution (OCR_KERNEL=scalar|sse|avx2 pour forcer).
+
+#ifndef OCR_SIMD
+#define OCR_SIMD 1
+#endif
+
+typedef struct ForwardKernel {
+    const char *name;
+    // y[s*rows + r] = somme sur k de w[r*cols + k] * x[s*cols + k], pour s < n
+    void (*matmul)(const float *w, int rows, int cols, const float *x, int n, float *y);
+    // x[i] = exp(x[i]) (approximation polynomiale dans les versions vectorielles)
+    void (*exp)(float *x, int n);
+} ForwardKernel;
+
+const ForwardKernel *forward_kernel_select(void);
+
+#endif
@@ -3,66 +3,75 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <dirent.h>
-#include <sys/stat.h>
 
-static int detect_grid_col_size(const char* cells_dir) {
-    int max_col = -1;
-    
-    for (int c = 0; c < 50; c++) {
-        char path[512];
-        snprintf(path, sizeof(path), "%s/c_00_%02d.bmp", cells_dir, c);
-        
-        struct stat st;
-        if (stat(path, &st) == 0) {
-            max_col = c;
-        }
-    }
-    
-    return max_col + 1;
-}
+// Cells handed to a worker at a time: one recognize_batch block
+#define CELLS_PER_TASK BATCH_BLOCK
+
+// Shared, read-only description of the job; each task owns the glyph slots
+// and grid entries of its own cells
+typedef struct {
+    const Model* model;
+    const GlyphSet* cells;
+    float* glyphs;      // one INPUT_SIZE slot per cell
+    Grid* grid;
+} GridJob;
 
-static int detect_grid_row_size(const char* cells_dir) {
-    int max_row = -1;
-    
-    for (int r = 0; r < 50; r++) {
-        char path[512];
-        snprintf(path, sizeof(path), "%s/c_%02d_00.bmp", cells_dir, r);
-        
-        struct stat st;
-        if (stat(path, &st) == 0) {
-            max_row = r;
+// Normalizes and recognizes cells [task*CELLS_PER_TASK, (task+1)*CELLS_PER_TASK)
+static void recognize_cells(void* arg, int task) {
+    GridJob* job = (GridJob*)arg;
+    int first = task * CELLS_PER_TASK;
+    int last = first + CELLS_PER_TASK;
+    if (last > job->cells->count) last = job->cells->count;
+    
+    float* slots = job->glyphs + (size_t)first * INPUT_SIZE;
+    const Glyph* cell_of[CELLS_PER_TASK];
+    char letters[CELLS_PER_TASK];
+    int n_glyphs = 0;
+    
+    for (int i = first; i < last; i++) {
+        const Glyph* cell = &job->cells->items[i];
+        // scaled straight from the grid bitmap into the slot
+        GlyphView view = { job->cells, cell };
+        SDL_Rect r = cell->rect;
+        if (glyph_from_rect(glyph_gray, &view, r.x, r.y, r.w, r.h, slots + (size_t)n_glyphs * INPUT_SIZE) == 0) {
+            cell_of[n_glyphs++] = cell;
         }
     }
     
-    return max_row + 1;
+    recognize_batch(job->model, slots, n_glyphs, letters, NULL);
+    
+    for (int i = 0; i < n_glyphs; i++) {
+        job->grid->cells[cell_of[i]->row][cell_of[i]->col] = letters[i];
+    }
 }
 
 
-int process_grid(const char* cells_dir, const char* output_file) {
+int recognize_grid(const Model* model, ThreadPool* pool, const GlyphSet* cells, Grid* grid) {
     printf("\n========================================\n");
     printf("Grid Processing\n");
     printf("========================================\n");
-    printf("[GRID] Input: %s\n", cells_dir);
-    printf("[GRID] Output: %s\n", output_file);
     
 
-    // Detect grid dimensions
-    int grid_cols = detect_grid_col_size(cells_dir);
-    int grid_rows = detect_grid_row_size(cells_dir);
+    // Grid dimensions come from the slicer
+    int grid_cols = cells->cols;
+    int grid_rows = cells->rows;
     
-    if (grid_cols == 0 || grid_rows == 0) {
-        fprintf(stderr, "[GRID] ✗ No cells found in %s\n", cells_dir);
+    if (grid_cols == 0 || grid_rows == 0 || cells->count == 0) {
+        fprintf(stderr, "[GRID] ✗ No cells to recognize\n");
+        return -1;
+    }
+    if (grid_rows > MAX_ROWS || grid_cols > MAX_COLS) {
+        fprintf(stderr, "[GRID] ✗ Grid too large: %d rows × %d columns\n", grid_rows, grid_cols);
         return -1;
     }
     
     printf("[GRID] Detected grid size: %d rows × %d columns\n", grid_rows, grid_cols);
     
-    // Allocate grid (rows × columns)
-    char** grid = (char**)malloc(grid_rows * sizeof(char*));
+    grid->rows = grid_rows;
+    grid->cols = grid_cols;
     for (int i = 0; i < grid_rows; i++) {
-        grid[i] = (char*)malloc((grid_cols + 1) * sizeof(char));
-        grid[i][grid_cols] = '\0';  // Null terminate each row
+        memset(grid->cells[i], '?', grid_cols);  // cells that are missing or unreadable stay '?'
+        grid->cells[i][grid_cols] = '\0';  // Null terminate each row
     }
     
     // Process each cell
@@ -70,17 +79,27 @@ int process_grid(const char* cells_dir, const char* output_file) {
     int recognized = 0;
     int uncertain = 0;
     
-    printf("[GRID] Processing %d cells...\n", total_cells);
+    printf("[GRID] Processing %d cells on %d thread(s)...\n", total_cells, thread_pool_size(pool));
+    
+    // Cells are split into blocks of CELLS_PER_TASK; every block is normalized and
+    // classified by one worker, which writes its letters straight into grid
+    GridJob job = {
+        .model = model,
+        .cells = cells,
+        .glyphs = (float*)malloc((size_t)cells->count * INPUT_SIZE * sizeof(float)),
+        .grid = grid,
+    };
+    if (!job.glyphs) {
+        fprintf(stderr, "[GRID] ✗ Out of memory for %d glyphs\n", cells->count);
+        return -1;
+    }
+    int n_tasks = (cells->count + CELLS_PER_TASK - 1) / CELLS_PER_TASK;
+    thread_pool_run(pool, n_tasks, recognize_cells, &job);
+    free(job.glyphs);
     
     for (int row = 0; row < grid_rows; row++) {
         for (int col = 0; col < grid_cols; col++) {
-            char path[512];
-            snprintf(path, sizeof(path), "%s/c_%02d_%02d.bmp", cells_dir, row, col);
-            
-            char letter = recognize_letter(path);
-            grid[row][col] = letter;
-            
-            if (letter != '?') {
+            if (grid->cells[row][col] != '?') {
                 recognized++;
             } else {
                 uncertain++;
@@ -94,82 +113,10 @@ int process_grid(const char* cells_dir, const char* output_file) {
     printf("[GRID]   ? Uncertain:  %d/%d (%.1f%%)\n", 
            uncertain, total_cells, 100.0 * uncertain / total_cells);
     
-    // Write to file
-    FILE* f = fopen(output_file, "w");
-    if (!f) {
-        fprintf(stderr, "[GRID] ✗ Cannot create output file: %s\n", output_file);
-        for (int i = 0; i < grid_rows; i++) free(grid[i]);
-        free(grid);
-        return -1;
-    }
-
     for (int i = 0; i < grid_rows; i++) {
-        printf( "%s\n", grid[i]);
-        fprintf(f, "%s\n", grid[i]);
+        printf( "%s\n", grid->cells[i]);
     }
     
-    fclose(f);
-/*
-    //Conversion du tableau en SDL_surface
-    if (output_file) {
-        if (SDL_Init(0) != 0) {
-            fprintf(stderr, "[GRID] ✗ SDL_Init failed: %s\n", SDL_GetError());
-            
-            for (int i = 0; i < grid_rows; i++) free(grid[i]);
-            free(grid);
-            return -1;
-        }
-        
-        SDL_Surface *surf = SDL_CreateRGBSurface(0, grid_cols, grid_rows, 32,
-                                                 0x00FF0000,
-                                                 0x0000FF00,
-                                                 0x000000FF,
-                                                 0xFF000000);
-        if (!surf) {
-            fprintf(stderr, "[GRID] ✗ SDL_CreateRGBSurface failed: %s\n", SDL_GetError());
-            SDL_Quit();
-            for (int i = 0; i < grid_rows; i++) free(grid[i]);
-            free(grid);
-            return -1;
-        }
-        
-       // écriture en tenant compte du pitch (padding) //
-        Uint32 *pixels = (Uint32*)surf->pixels;
-        int pitch_pixels = surf->pitch / 4; // nombre d'Uint32 par ligne //
-        for (int y = 0; y < grid_rows; y++) {
-            for (int x = 0; x < grid_cols; x++) {
-                char ch = grid[y][x];
-                Uint8 v;
-                if (ch == '?') {
-                    v = 32; // sombre pour incertain //
-                } else {
-                    // exemple : lettre reconnue -> valeur lumineuse //
-                    v = 220;
-                }
-                Uint32 color = SDL_MapRGBA(surf->format, v, v, v, 255);
-                pixels[y * pitch_pixels + x] = color;
-            }
-        }
-        
-        if (SDL_SaveBMP(surf, output_file) != 0) {
-            fprintf(stderr, "[GRID] ✗ SDL_SaveBMP failed: %s\n", SDL_GetError());
-            SDL_FreeSurface(surf);
-            SDL_Quit();
-            for (int i = 0; i < grid_rows; i++) free(grid[i]);
-            free(grid);
-            return -1;
-        }
-        
-        SDL_FreeSurface(surf);
-        SDL_Quit();
-    }
-*/
-    // Cleanup
-    for (int i = 0; i < grid_rows; i++) free(grid[i]);
-    free(grid);
-    
-    printf("[GRID] ✓ Grid saved to: %s\n", output_file);
-    
     if (uncertain > total_cells / 4) {
         printf("[GRID] ⚠️  Warning: >25%% uncertain letters. Check training templates!\n");
     }
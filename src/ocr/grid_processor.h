@@ -1,7 +1,13 @@
 #ifndef GRID_PROCESSOR_H
 #define GRID_PROCESSOR_H
 
+#include "letter_recognition.h"
+#include "../utils/thread_pool.h"
+#include "../extraction/glyph_set.h"
+#include "../solver/solver.h"
 
-int process_grid(const char* cells_dir, const char* output_file);
+// Recognizes every cell into grid (sized from cells->rows × cells->cols)
+// pool spreads the cells across worker threads (NULL = current thread only)
+int recognize_grid(const Model* model, ThreadPool* pool, const GlyphSet* cells, Grid* grid);
 
 #endif
@@ -9,27 +9,7 @@
 #include <err.h>
 #include <time.h>
 #include <sys/stat.h>
-
-#define INPUT_SIZE 1024
-#define HIDDEN_SIZE 128
-#define OUTPUT_SIZE 26
-#define LEARNING_RATE 0.01
-#define MAX_TEMPLATES_PER_LETTER 1300
-#define TEMPLATE_SIZE 32
-#define EPOCHS 20  // Modifie cette valeur si tu veux plus/moins d'époques
-
-float input[INPUT_SIZE];
-float hidden[HIDDEN_SIZE];
-float output[OUTPUT_SIZE];
-
-float wIH[INPUT_SIZE][HIDDEN_SIZE]; // poids input-hidden
-float bH[HIDDEN_SIZE];              // biais hidden
-
-float wHO[HIDDEN_SIZE][OUTPUT_SIZE]; // poids hidden-output
-float bO[OUTPUT_SIZE];               // biais output
-
-
-static int is_sdl_initialized = 0;
+#include "letter_recognition.h"
 
 //remplir un tableau 1D depuis un fichier texte
 void load1D(const char *filename, float *array, int size)
@@ -66,12 +46,109 @@ void load2D(const char *filename, int rows, int cols, float matrix[rows][cols])
     fclose(fp);
 }
 
-void loads()
+//recharge dans net les poids écrits par store_res (pour reprendre un entrainement)
+void loads(Network *net)
+{
+    load2D(MODEL_DIR "/wIH.txt",INPUT_SIZE, HIDDEN_SIZE,net->wIH);
+    load2D(MODEL_DIR "/wHO.txt",HIDDEN_SIZE, OUTPUT_SIZE,net->wHO);
+    load1D(MODEL_DIR "/bH.txt", net->bH, HIDDEN_SIZE);
+    load1D(MODEL_DIR "/bO.txt", net->bO, OUTPUT_SIZE);
+}
+
+//charge un modèle depuis les fichiers texte wIH.txt, wHO.txt, bH.txt et bO.txt de dir
+Model *model_load_text(const char *dir)
+{
+    Model *model = model_alloc();
+    if (!model) errx(EXIT_FAILURE, "Erreur : allocation du modèle impossible");
+
+    // wIH.txt est rangé entrée par entrée : on le transpose dans wHI pour le calcul
+    float (*w)[HIDDEN_SIZE] = malloc(sizeof(float[INPUT_SIZE][HIDDEN_SIZE]));
+    if (!w) errx(EXIT_FAILURE, "Erreur : allocation du modèle impossible");
+
+    // le bloc vient de malloc, on peut donc écrire dans les tableaux
+    char path[512];
+    snprintf(path, sizeof(path), "%s/wIH.txt", dir);
+    load2D(path, INPUT_SIZE, HIDDEN_SIZE, w);
+    float *wHI = (float *)model->wHI;
+    for (int i=0;i<INPUT_SIZE;i++)
+    {
+        for (int j=0;j<HIDDEN_SIZE;j++)
+        {
+            wHI[j*INPUT_SIZE+i]=w[i][j];
+        }
+    }
+    free(w);
+
+    // de même wHO.txt est transposé dans wOH
+    float (*o)[OUTPUT_SIZE] = malloc(sizeof(float[HIDDEN_SIZE][OUTPUT_SIZE]));
+    if (!o) errx(EXIT_FAILURE, "Erreur : allocation du modèle impossible");
+    snprintf(path, sizeof(path), "%s/wHO.txt", dir);
+    load2D(path, HIDDEN_SIZE, OUTPUT_SIZE, o);
+    float *wOH = (float *)model->wOH;
+    for (int i=0;i<HIDDEN_SIZE;i++)
+    {
+        for (int j=0;j<OUTPUT_SIZE;j++)
+        {
+            wOH[j*HIDDEN_SIZE+i]=o[i][j];
+        }
+    }
+    free(o);
+
+    snprintf(path, sizeof(path), "%s/bH.txt", dir);
+    load1D(path, (float *)model->bH, HIDDEN_SIZE);
+    snprintf(path, sizeof(path), "%s/bO.txt", dir);
+    load1D(path, (float *)model->bO, OUTPUT_SIZE);
+
+    return model;
+}
+
+//model.bin ne sert que s'il est plus récent que chacun des fichiers texte dont il est tiré :
+//un fichier texte supprimé (pour réentrainer) ou remplacé le rend périmé
+static int model_file_fresh(void)
 {
-    load2D("./output/wIH.txt",INPUT_SIZE, HIDDEN_SIZE,wIH);
-    load2D("./output/wHO.txt",HIDDEN_SIZE, OUTPUT_SIZE,wHO);
-    load1D("./output/bH.txt", bH, HIDDEN_SIZE);
-    load1D("./output/bO.txt", bO, OUTPUT_SIZE);
+    static const char *names[] = { "wIH.txt", "wHO.txt", "bH.txt", "bO.txt" };
+    struct stat bin;
+    if (stat(MODEL_FILE, &bin) != 0) return 0;
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", MODEL_DIR, names[i]);
+        struct stat txt;
+        if (stat(path, &txt) != 0 || txt.st_mtime > bin.st_mtime) return 0;
+    }
+    return 1;
+}
+
+//charge le modèle une seule fois : model.bin par mmap s'il est à jour, sinon les fichiers texte
+//(lance l'entrainement s'ils n'existent pas) puis réécrit model.bin pour les lancements suivants
+Model *model_load(void)
+{
+    Model *model = model_file_fresh() ? model_map(MODEL_FILE) : NULL;
+    if (model)
+    {
+        printf("[OCR] Model mapped from %s (kernel: %s)\n", MODEL_FILE, model->kernel->name);
+        return model;
+    }
+
+    FILE *file = fopen(MODEL_DIR "/bH.txt", "r");
+    if (file)
+    {
+        fclose(file);
+    }
+    else
+    {
+        srand((unsigned int)time(NULL));
+        train();
+    }
+
+    model = model_load_text(MODEL_DIR);
+    printf("[OCR] Model loaded from %s (kernel: %s)\n", MODEL_DIR, model->kernel->name);
+
+    if (model_save(model, MODEL_FILE) == 0)
+        printf("[OCR] Binary model written to %s\n", MODEL_FILE);
+
+    return model;
 }
 
 //fonction sigmoid
@@ -109,13 +186,13 @@ float random_weight()
 }
 
 // initialise les poids et biais aléatoirement pour commencer
-void init_weights()
+void init_weights(Network *net)
 {
     for(int i=0;i<INPUT_SIZE;i++)
     {
         for(int j=0;j<HIDDEN_SIZE;j++)
         {
-            wIH[i][j]=random_weight();
+            net->wIH[i][j]=random_weight();
         }
     }
 
@@ -123,166 +200,226 @@ void init_weights()
     {
         for(int j=0;j<OUTPUT_SIZE;j++)
         {
-            wHO[i][j]=random_weight();
+            net->wHO[i][j]=random_weight();
         }
     }
 
     for(int i=0;i<HIDDEN_SIZE;i++)
     {
-        bH[i]=random_weight();
+        net->bH[i]=random_weight();
     }
 
     for(int i=0;i<OUTPUT_SIZE;i++)
     {
-        bO[i]=random_weight();
+        net->bO[i]=random_weight();
     }
 }
 
 //calcul la couche cachée
-void calcul_hidden()
+void calcul_hidden(Network *net)
 {
     for(int i=0;i<HIDDEN_SIZE;i++)
     {
-        float tot=bH[i];
+        float tot=net->bH[i];
         for(int j=0;j<INPUT_SIZE;j++)
         {
-            tot+=wIH[j][i]*input[j];
+            tot+=net->wIH[j][i]*net->input[j];
         }
-        hidden[i]=sigmoid(tot);
+        net->hidden[i]=sigmoid(tot);
     }
 }
 
 //calcul la couche de sortie
-void calcul_output()
+void calcul_output(Network *net)
 {
     float temp[OUTPUT_SIZE];
     for(int i=0;i<OUTPUT_SIZE;i++)
     {
-        float tot=bO[i];
+        float tot=net->bO[i];
         for(int j=0;j<HIDDEN_SIZE;j++)
         {
-            tot+=wHO[j][i]*hidden[j];
+            tot+=net->wHO[j][i]*net->hidden[j];
         }
         temp[i]=tot;
     }
-    softmax(temp,output,OUTPUT_SIZE);
+    softmax(temp,net->output,OUTPUT_SIZE);
 }
 
 //lance le réseau de neurone et fait les calculs dans les différentes couches
-void forward()
+void forward(Network *net)
+{
+    calcul_hidden(net);
+    calcul_output(net);
+}
+
+//propagation avant de bs lettres (bs <= BATCH_BLOCK) avec les poids d'un modèle chargé
+//probs reçoit bs x OUTPUT_SIZE probabilités ; les tampons intermédiaires sont sur la pile
+//de l'appelant, plusieurs threads peuvent donc partager le même modèle sans verrou
+static void forward_block(const Model *model, const float *glyphs, int bs, float *probs)
+{
+    const ForwardKernel *k = model->kernel;
+    float hid[BATCH_BLOCK * HIDDEN_SIZE];
+
+    //couche cachée : produit matrice-matrice des lettres par wHI, puis sigmoid = 1/(1+exp(-x))
+    k->matmul(model->wHI, HIDDEN_SIZE, INPUT_SIZE, glyphs, bs, hid);
+    for (int s=0;s<bs;s++)
+    {
+        for (int i=0;i<HIDDEN_SIZE;i++)
+        {
+            hid[s*HIDDEN_SIZE+i] = -(hid[s*HIDDEN_SIZE+i]+model->bH[i]);
+        }
+    }
+    k->exp(hid, bs*HIDDEN_SIZE);
+    for (int i=0;i<bs*HIDDEN_SIZE;i++) hid[i]=1.0f/(1.0f+hid[i]);
+
+    //couche de sortie (même noyau avec wOH) puis softmax
+    k->matmul(model->wOH, OUTPUT_SIZE, HIDDEN_SIZE, hid, bs, probs);
+    for (int s=0;s<bs;s++)
+    {
+        float *p = probs + s*OUTPUT_SIZE;
+        for (int i=0;i<OUTPUT_SIZE;i++) p[i]+=model->bO[i];
+
+        float maxv = p[0];
+        for (int i=1;i<OUTPUT_SIZE;i++) if (p[i]>maxv) maxv=p[i];
+        for (int i=0;i<OUTPUT_SIZE;i++) p[i]-=maxv;
+        k->exp(p, OUTPUT_SIZE);
+
+        float sum=0.0f;
+        for (int i=0;i<OUTPUT_SIZE;i++) sum+=p[i];
+        if (sum == 0.0f) sum = 1e-20f;
+        for (int i=0;i<OUTPUT_SIZE;i++) p[i]/=sum;
+    }
+}
+
+//propagation avant d'une seule lettre
+void model_forward(const Model *model, const float *in, float *out)
+{
+    forward_block(model, in, 1, out);
+}
+
+//reconnait n lettres d'un coup : glyphs contient n images normalisées de INPUT_SIZE pixels à la suite
+//les lettres passent par blocs de BATCH_BLOCK dans le noyau matrice-matrice du modèle
+//out[k] reçoit la lettre reconnue et conf[k] (si conf != NULL) sa probabilité
+void recognize_batch(const Model *model, const float *glyphs, int n, char *out, float *conf)
 {
-    calcul_hidden();
-    calcul_output();
+    float probs[BATCH_BLOCK * OUTPUT_SIZE];
+
+    for (int s0 = 0; s0 < n; s0 += BATCH_BLOCK)
+    {
+        int bs = (n - s0 < BATCH_BLOCK) ? n - s0 : BATCH_BLOCK;
+        forward_block(model, glyphs + (size_t)s0 * INPUT_SIZE, bs, probs);
+
+        for (int s = 0; s < bs; s++)
+        {
+            const float *p = probs + s * OUTPUT_SIZE;
+            int max = 0;
+            for (int i = 1; i < OUTPUT_SIZE; i++)
+                if (p[i] > p[max]) max = i;
+
+            out[s0 + s] = (char)('A' + max);
+            if (conf) conf[s0 + s] = p[max];
+        }
+    }
 }
 
 //calcul erreur de la couche de sortie
-void calcul_errorO(float *errorO,int index_letter)
+void calcul_errorO(const Network *net, float *errorO,int index_letter)
 {
     for(int i=0;i<OUTPUT_SIZE;i++)
     {
-        errorO[i]=output[i]-(i==index_letter?1.0f:0.0f);
+        errorO[i]=net->output[i]-(i==index_letter?1.0f:0.0f);
     }
 }
 
 //calcul erreur de la couche cachée
-void calcul_errorH(float *errorH,float *errorO)
+void calcul_errorH(const Network *net, float *errorH,float *errorO)
 {
     for(int i=0;i<HIDDEN_SIZE;i++)
     {
         float new_value=0.0f;
         for (int j=0;j<OUTPUT_SIZE;j++)
         {
-            new_value+=errorO[j]*wHO[i][j];
+            new_value+=errorO[j]*net->wHO[i][j];
         }
-        errorH[i]=new_value*hidden[i]*(1-hidden[i]);
+        errorH[i]=new_value*net->hidden[i]*(1-net->hidden[i]);
     }
 }
 
 //met à jour les poids et biais vers la couche de sortie
-void update_HO(float *errorO)
+void update_HO(Network *net, float *errorO)
 {
     for (int i=0;i<HIDDEN_SIZE;i++)
     {
         for (int j=0;j<OUTPUT_SIZE;j++)
         {
-            wHO[i][j]-=LEARNING_RATE*errorO[j]*hidden[i] ;
+            net->wHO[i][j]-=LEARNING_RATE*errorO[j]*net->hidden[i] ;
         }
     }
 
     for(int i=0;i<OUTPUT_SIZE;i++)
     {
-        bO[i]-=LEARNING_RATE*errorO[i];
+        net->bO[i]-=LEARNING_RATE*errorO[i];
     }
 }
 
 //met à jour les poids et biais vers la couche cachée
-void update_IH(float *errorH)
+void update_IH(Network *net, float *errorH)
 {
     for (int i=0;i<INPUT_SIZE;i++)
     {
         for (int j=0;j<HIDDEN_SIZE;j++)
         {
-            wIH[i][j]-=LEARNING_RATE*errorH[j]*input[i] ;
+            net->wIH[i][j]-=LEARNING_RATE*errorH[j]*net->input[i] ;
         }
     }
 
     for(int i=0;i<HIDDEN_SIZE;i++)
     {
-        bH[i]-=LEARNING_RATE*errorH[i];
+        net->bH[i]-=LEARNING_RATE*errorH[i];
     }
 }
 
 // lance le recalcul des poids et biais en fonction du résultat voulu pour une letter
-void back_propagation(int index_letter)
+void back_propagation(Network *net, int index_letter)
 {
     float errorO[OUTPUT_SIZE];
     float errorH[HIDDEN_SIZE];
-    calcul_errorO(errorO,index_letter);
-    calcul_errorH(errorH,errorO);
+    calcul_errorO(net,errorO,index_letter);
+    calcul_errorH(net,errorH,errorO);
 
-    update_HO(errorO);
-    update_IH(errorH);
+    update_HO(net,errorO);
+    update_IH(net,errorH);
 }
 
 
 // Ajoute un léger bruit aléatoire à l'entrée pour robustifier l'apprentissage
-void add_noise(float strength) {
+static void add_noise(Network *net, float strength) {
     for (int i = 0; i < INPUT_SIZE; i++) {
         // Ajoute une valeur entre -strength et +strength
         float noise = ((float)rand() / (float)RAND_MAX - 0.5f) * 2.0f * strength;
-        input[i] += noise;
+        net->input[i] += noise;
         // Clamp pour rester entre 0 et 1 (optionnel mais recommandé)
-        if (input[i] < 0.0f) input[i] = 0.0f;
-        if (input[i] > 1.0f) input[i] = 1.0f;
+        if (net->input[i] < 0.0f) net->input[i] = 0.0f;
+        if (net->input[i] > 1.0f) net->input[i] = 1.0f;
     }
 }
 
 //entraine le réseau avec des images données
-void training(int index_letter, float **img)
+void training(Network *net, int index_letter, const float *img)
 {
     if (!img) errx(EXIT_FAILURE,"matrice nulle");
-    for(int i=0;i<32;i++)  if(!img[i]) errx(EXIT_FAILURE,"ligne %d n'existe pas", i);
+    memcpy(net->input, img, INPUT_SIZE * sizeof(float));
 
-    int n=0;
-    for(size_t i=0;i<TEMPLATE_SIZE && n < INPUT_SIZE;i++)
-    {
-        for(size_t j=0;j<TEMPLATE_SIZE && n < INPUT_SIZE;j++)
-        {
-            input[n]=img[i][j];
-            n++;
-        }
-    }
-
-    add_noise(0.05f);
-    forward();
-    back_propagation(index_letter);
+    add_noise(net, 0.05f);
+    forward(net);
+    back_propagation(net, index_letter);
 }
 
 //stocke le valeurs obtenues pour les biais et les poids dans des fichiers texte
-int store_res()
+int store_res(const Network *net)
 {
     // écrit les poids input-hidden
-    FILE *fp1 = fopen("./output/wIH.txt", "w");
+    FILE *fp1 = fopen(MODEL_DIR "/wIH.txt", "w");
     if (!fp1)
     {
         printf("Erreur : impossible d'ouvrir le fichier wIH.txt\n");
@@ -292,7 +429,7 @@ int store_res()
     {
         for(int j=0;j<HIDDEN_SIZE;j++)
         {
-            fprintf(fp1, "%.6f ", wIH[i][j]);
+            fprintf(fp1, "%.6f ", net->wIH[i][j]);
         }
         fprintf(fp1,"\n");
     }
@@ -300,7 +437,7 @@ int store_res()
     fclose(fp1);
 
     // écrit les poids hidden-output
-    FILE *fp2 = fopen("./output/wHO.txt", "w");
+    FILE *fp2 = fopen(MODEL_DIR "/wHO.txt", "w");
     if (!fp2)
     {
         printf("Erreur : impossible d'ouvrir le fichier wHO.txt\n");
@@ -310,7 +447,7 @@ int store_res()
     {
         for (int j=0;j<OUTPUT_SIZE;j++)
         {
-            fprintf(fp2, "%.6f ", wHO[i][j]);
+            fprintf(fp2, "%.6f ", net->wHO[i][j]);
         }
         fprintf(fp2,"\n");
     }
@@ -318,7 +455,7 @@ int store_res()
     fclose(fp2);
 
     // écrit les biais input-hidden
-    FILE *fp3 = fopen("./output/bH.txt", "w");
+    FILE *fp3 = fopen(MODEL_DIR "/bH.txt", "w");
     if (!fp3)
     {
         printf("Erreur : impossible d'ouvrir le fichier bH.txt\n");
@@ -326,13 +463,13 @@ int store_res()
     }
     for (int i=0;i<HIDDEN_SIZE ;i++)
     {
-        fprintf(fp3, "%.6f ", bH[i]);
+        fprintf(fp3, "%.6f ", net->bH[i]);
     }
     fprintf(fp3, "\n");
     fclose(fp3);
 
     // écrit les biais hidden-output
-    FILE *fp4 = fopen("./output/bO.txt", "w");
+    FILE *fp4 = fopen(MODEL_DIR "/bO.txt", "w");
     if (!fp4)
     {
         printf("Erreur : impossible d'ouvrir le fichier bO.txt\n");
@@ -340,7 +477,7 @@ int store_res()
     }
     for (int i=0;i<OUTPUT_SIZE ;i++)
     {
-        fprintf(fp4, "%.6f ", bO[i]);
+        fprintf(fp4, "%.6f ", net->bO[i]);
     }
     fprintf(fp4, "\n");
     fclose(fp4);
@@ -348,34 +485,60 @@ int store_res()
     return 0;
 }
 
-typedef struct
+// Met le rectangle w x h en (x, y) d'une image à TEMPLATE_SIZE x TEMPLATE_SIZE, directement
+// dans les INPUT_SIZE flottants de glyph (ligne par ligne) : chaque case prend le pixel source
+// le plus proche de son centre, en virgule fixe 16.16 comme SDL_BlitScaled, avec lequel les
+// poids ont été entraînés. Aucune surface intermédiaire, aucune conversion de format.
+// renvoie 0, ou -1 si le rectangle est vide
+int glyph_from_rect(GlyphPixelFn gray, const void *src, int x, int y, int w, int h, float *glyph)
 {
-    SDL_Surface* templates[MAX_TEMPLATES_PER_LETTER];
-    int count;
-} LetterTemplates;
-
-static LetterTemplates letter_templates[26];  // A-Z
-static int total_templates = 0;
-
-// Normalize image to fixed size
-SDL_Surface* normalize_size(SDL_Surface* img, int target_w, int target_h)
-{
-    if (!img) return NULL;
-
-    SDL_Surface* normalized = SDL_CreateRGBSurfaceWithFormat(
-        0, target_w, target_h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (w <= 0 || h <= 0) return -1;
 
-    if (!normalized) return NULL;
+    Uint32 incx = ((Uint32)w << 16) / TEMPLATE_SIZE;
+    Uint32 incy = ((Uint32)h << 16) / TEMPLATE_SIZE;
+    int sx[TEMPLATE_SIZE];
+    for (int j = 0; j < TEMPLATE_SIZE; j++) sx[j] = x + (int)((incx / 2 + j * incx) >> 16);
 
-    SDL_Rect src = {0, 0, img->w, img->h};
-    SDL_Rect dst = {0, 0, target_w, target_h};
-    if (SDL_BlitScaled(img, &src, normalized, &dst) != 0)
+    for (int i = 0; i < TEMPLATE_SIZE; i++)
     {
-        SDL_FreeSurface(normalized);
-        return NULL;
+        int sy = y + (int)((incy / 2 + i * incy) >> 16);
+        for (int j = 0; j < TEMPLATE_SIZE; j++)
+            glyph[i * TEMPLATE_SIZE + j] = gray(src, sx[j], sy);
     }
+    return 0;
+}
+
+// Gris (0 noir, 1 blanc) d'un pixel d'une SDL_Surface de n'importe quel format : moyenne RGB,
+// assombrie par la transparence quand la surface se mélange (comme sur le fond noir de
+// l'ancienne surface 32x32)
+typedef struct {
+    const SDL_Surface *img;
+    SDL_BlendMode mode; // lu une fois par l'appelant
+} SurfaceView;
 
-    return normalized;
+static float surface_gray(const void *src, int x, int y)
+{
+    const SurfaceView *view = (const SurfaceView *)src;
+    const SDL_Surface *img = view->img;
+    const Uint8 *p = (const Uint8 *)img->pixels + y * img->pitch + x * img->format->BytesPerPixel;
+
+    Uint32 pixel;
+    switch (img->format->BytesPerPixel) {
+    case 1: pixel = *p; break;
+    case 2: pixel = *(const Uint16 *)p; break;
+    case 3:
+        pixel = SDL_BYTEORDER == SDL_BIG_ENDIAN ? (Uint32)p[0] << 16 | p[1] << 8 | p[2]
+                                                : (Uint32)p[0] | p[1] << 8 | p[2] << 16;
+        break;
+    default: pixel = *(const Uint32 *)p; break;
+    }
+
+    Uint8 r, g, b, a;
+    SDL_GetRGBA(pixel, img->format, &r, &g, &b, &a);
+    float gray = (r + g + b) / 3.0f / 255.0f;
+
+    if (view->mode == SDL_BLENDMODE_BLEND && a != 255) gray *= a / 255.0f;
+    return gray;
 }
 
 // Helper : retourne 1 si 'name' se termine par une extension d'image connue (insensible à la casse)
@@ -395,8 +558,9 @@ static int is_image_filename(const char *name)
 
 // Initialize with training templates
 // Expects 'dossier' to contain subfolders named "A", "B", ..., "Z".
-// Each subfolder is scanned and up to MAX_TEMPLATES_PER_LETTER image files are loaded.
-void load_letter_template(const char *dossier)
+// Each subfolder is scanned and up to MAX_TEMPLATES_PER_LETTER image files are loaded
+// into letter_templates[26]; returns the total number of templates.
+int load_letter_template(const char *dossier, LetterTemplates *letter_templates)
 {
     // Initialize structures
     for (int i = 0; i < 26; i++) {
@@ -406,7 +570,7 @@ void load_letter_template(const char *dossier)
         }
     }
 
-    total_templates = 0;
+    int total_templates = 0;
 
     for (int i = 0; i < 26; i++) {
         char letter = 'A' + i;
@@ -433,21 +597,15 @@ void load_letter_template(const char *dossier)
             char path[1024];
             snprintf(path, sizeof(path), "%s/%s", subdir, entry->d_name);
 
-            SDL_Surface* img = IMG_Load(path); // supporte png/jpg/bmp via SDL_image
-            if (!img) {
-                fprintf(stderr, "[OCR] Impossible de charger %s : %s\n", path, IMG_GetError());
+            // supporte png/jpg/bmp via SDL_image, déjà à l'entrée du réseau
+            float* glyph = malloc(INPUT_SIZE * sizeof(float));
+            if (!glyph) errx(EXIT_FAILURE, "Allocation échouée");
+            if (load_glyph(path, glyph) != 0) {
+                free(glyph);
                 continue;
             }
 
-            SDL_Surface* norm = normalize_size(img, TEMPLATE_SIZE, TEMPLATE_SIZE);
-            SDL_FreeSurface(img);
-
-            if (!norm) {
-                fprintf(stderr, "[OCR] normalize_size failed for %s: %s\n", path, SDL_GetError());
-                continue;
-            }
-
-            letter_templates[i].templates[loaded] = norm;
+            letter_templates[i].templates[loaded] = glyph;
             loaded++;
             total_templates++;
         }
@@ -461,64 +619,22 @@ void load_letter_template(const char *dossier)
     if (total_templates == 0) {
         errx(EXIT_FAILURE, "[OCR] ⚠️  No templates found in any subdirectory of %s\n", dossier);
     }
-}
-
-// convertie une sdl_surface en une matrice de 32*32
-float **surface_to_grayscale(SDL_Surface *img)
-{
-    if (!img) return NULL;
-
-    // Convertit en format 32 bits ARGB8888 pour simplifier (cohérent avec normalize_size)
-    SDL_Surface *converted = SDL_ConvertSurfaceFormat(img, SDL_PIXELFORMAT_ARGB8888, 0);
-    if (!converted) {
-        fprintf(stderr, "SDL_ConvertSurfaceFormat failed: %s\n", SDL_GetError());
-        return NULL;
-    }
-
-    int w = converted->w;
-    int h = converted->h;
-
-    // Allocation du tableau 2D
-    float **pixels = malloc(h * sizeof(float *));
-    if (!pixels) {
-        SDL_FreeSurface(converted);
-        return NULL;
-    }
-    for (int y = 0; y < h; y++) {
-        pixels[y] = malloc(w * sizeof(float));
-        if (!pixels[y]) {
-            for (int k=0;k<y;k++) free(pixels[k]);
-            free(pixels);
-            SDL_FreeSurface(converted);
-            return NULL;
-        }
-    }
-
-    Uint8 *p = (Uint8 *)converted->pixels;
-
-    for (int y=0;y<h;y++) {
-        for (int x=0;x<w;x++) {
-            Uint32 pixel = *((Uint32 *)(p + y * converted->pitch + x * 4));
-            Uint8 r, g, b, a;
-            SDL_GetRGBA(pixel, converted->format, &r, &g, &b, &a);
-
-            // Si l'image a de l'alpha (transparence), on peut traiter alpha==0 comme blanc (1.0)
-            // Ici on ignore alpha et prend juste la moyenne RGB
-            float gray = (r + g + b) / 3.0f / 255.0f;
-            pixels[y][x] = gray;
-        }
-    }
-
-    SDL_FreeSurface(converted);
-    return pixels;
+    return total_templates;
 }
 
 // lance l'entrainement avec un grand nombre d'exemple de lettres
+// le réseau et les templates sont alloués ici et libérés à la fin
 int train()
 {
-    init_weights();
-   // load_letter_template("./dataset");
-    load_letter_template("./dataset");
+    // les poids vont changer : model.bin ne doit plus être chargé
+    remove(MODEL_FILE);
+
+    Network *net = malloc(sizeof(Network));
+    LetterTemplates *letter_templates = malloc(26 * sizeof(LetterTemplates));
+    if (!net || !letter_templates) errx(EXIT_FAILURE, "Allocation échouée");
+
+    init_weights(net);
+    load_letter_template("./dataset", letter_templates);
 
     // Construire la liste des paires (lettre, variante)
     int available = 0;
@@ -562,164 +678,75 @@ int train()
         for (int t = 0; t < available; t++) {
             int li = items[t].letter;
             int vi = items[t].variant;
-            SDL_Surface* img = letter_templates[li].templates[vi];
-            if (!img) continue;
-            float** img_pixel = surface_to_grayscale(img);
-            if (!img_pixel) {
-                fprintf(stderr, "surface_to_grayscale failed for letter %c template %d\n", 'A'+li, vi);
-                continue;
-            }
-            training(li, img_pixel);
-            for (int y = 0; y < TEMPLATE_SIZE; y++) free(img_pixel[y]);
-            free(img_pixel);
+            const float* glyph = letter_templates[li].templates[vi];
+            if (!glyph) continue;
+            training(net, li, glyph);
         }
     }
 
     free(items);
 
-    // free template surfaces (nous n'en avons plus besoin après training)
+    // free templates (nous n'en avons plus besoin après training)
     for (int i=0;i<26;i++){
         for (int j=0;j<MAX_TEMPLATES_PER_LETTER;j++){
-            if (letter_templates[i].templates[j]) {
-                SDL_FreeSurface(letter_templates[i].templates[j]);
-                letter_templates[i].templates[j] = NULL;
-            }
+            free(letter_templates[i].templates[j]);
+            letter_templates[i].templates[j] = NULL;
         }
         letter_templates[i].count = 0;
     }
 
-    int store=store_res();
+    free(letter_templates);
+
+    int store=store_res(net);
+    free(net);
     if (store!=0) errx(EXIT_FAILURE,"erreur ecriture fichier");
     return 0;
 }
 
-//renvoie le résultat de la reconnaissant de la lettre sur une image rentrée en paramètre sous la forme d'une matrice
-char letter_recognition(float **img)
+//renvoie le résultat de la reconnaissant de la lettre sur une image rentrée en paramètre (INPUT_SIZE niveaux de gris)
+char letter_recognition(const Model *model, const float *img)
 {
-    loads();
-
-    int n=0;
-    for(size_t i=0;i<TEMPLATE_SIZE && n < INPUT_SIZE;i++)
-    {
-        for(size_t j=0;j<TEMPLATE_SIZE && n < INPUT_SIZE;j++)
-        {
-            input[n]=img[i][j];
-            n++;
-        }
-    }
-    forward();
+    float out[OUTPUT_SIZE];
+    model_forward(model, img, out);
 
     int max=0;
     for(int i=0;i<OUTPUT_SIZE;i++)
     {
-       // printf("proba lettre %c : %.3f\n",'A'+i,output[i]);
-        if (output[i]>output[max]) max=i;
+       // printf("proba lettre %c : %.3f\n",'A'+i,out[i]);
+        if (out[i]>out[max]) max=i;
     }
 
-   // printf("\nLetter reconnu : %c  avec une proba de %.3f\n",'A'+max,output[max]);
+   // printf("\nLetter reconnu : %c  avec une proba de %.3f\n",'A'+max,out[max]);
     return (char)('A'+max);
 }
 
 
 
-// Fonction helper pour initialiser la SDL une seule fois
-void ensure_sdl_initialized()
+// normalise une image de lettre déjà en mémoire en INPUT_SIZE niveaux de gris dans glyph
+// renvoie 0 si tout s'est bien passé, -1 sinon (img n'est pas libérée)
+int glyph_from_surface(SDL_Surface *img, float *glyph)
 {
-    if (is_sdl_initialized) return; // Si déjà init, on ne fait rien
-
-    // Initialisation SDL
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        errx(EXIT_FAILURE, "SDL_Init Failed: %s\n", SDL_GetError());
-    }
-
-    // Initialisation SDL_image (PNG/JPG)
-    int img_flags = IMG_INIT_PNG | IMG_INIT_JPG;
-    if ((IMG_Init(img_flags) & img_flags) != img_flags) {
-        fprintf(stderr, "IMG_Init Failed: %s\n", IMG_GetError());
-        SDL_Quit();
-        errx(EXIT_FAILURE, "Impossible d'initialiser SDL_image");
-    }
-
-    // On marque comme initialisé pour ne plus repasser ici
-    is_sdl_initialized = 1;
-
-    // Optionnel : on demande à fermer proprement la SDL quand le programme entier s'arrête
-    atexit(IMG_Quit);
-    atexit(SDL_Quit);
+    if (!img) return -1;
+    SurfaceView view = { img, SDL_BLENDMODE_NONE };
+    SDL_GetSurfaceBlendMode(img, &view.mode);
+    if (SDL_MUSTLOCK(img)) SDL_LockSurface(img);
+    int ret = glyph_from_rect(surface_gray, &view, 0, 0, img->w, img->h, glyph);
+    if (SDL_MUSTLOCK(img)) SDL_UnlockSurface(img);
+    return ret;
 }
 
-
-char recognize_letter(char *path_letter)
+// charge une image de lettre et la normalise en INPUT_SIZE niveaux de gris dans glyph
+// renvoie 0 si tout s'est bien passé, -1 sinon
+// SDL_image doit déjà être initialisé (voir ocr_session_open)
+int load_glyph(const char *path, float *glyph)
 {
-    ensure_sdl_initialized();
-
-    // initialisation aléatoire (peut rester ici ou bouger dans ensure_sdl_initialized)
-    // On met un static pour éviter de reset le seed à chaque appel rapide
-    static int rand_init = 0;
-    if (!rand_init) {
-        srand((unsigned int)time(NULL));
-        rand_init = 1;
-    }
-
-    // initialisation aleatoire
-    srand((unsigned int)time(NULL));
-
-    // lance le training si tous les fichiers bH, bO ... n'existent pas
-    FILE *file = fopen( "./output/bH.txt", "r");
-    
-    if (file)
-    {
-        fclose(file);
-    }
-    else train();
-
-    // Vérifie après training que les fichiers existent
-    FILE *file1 = fopen( "./output/bH.txt", "r");
-    if (file1)
-    {
-        fclose(file1);
-    }
-    else {
-        IMG_Quit();
-        SDL_Quit();
-        errx(EXIT_FAILURE,"erreur lors du training");
-    }
-
-    char *path=path_letter;
-
     SDL_Surface *img = IMG_Load(path); // utilise IMG_Load pour PNG/JPG/BMP
     if (!img) {
-        IMG_Quit();
-        SDL_Quit();
-        errx(EXIT_FAILURE, "erreur lors du chargement de l'image: %s", IMG_GetError());
+        fprintf(stderr, "erreur lors du chargement de l'image %s: %s\n", path, IMG_GetError());
+        return -1;
     }
 
-    SDL_Surface *norm = normalize_size(img, TEMPLATE_SIZE, TEMPLATE_SIZE);
+    int ret = glyph_from_surface(img, glyph);
     SDL_FreeSurface(img);
-    if (!norm) {
-        IMG_Quit();
-        SDL_Quit();
-        errx(EXIT_FAILURE, "normalize_size a échoué");
-    }
-
-    float **img_pixel = surface_to_grayscale(norm);
-    SDL_FreeSurface(norm);
-    if (!img_pixel) {
-        IMG_Quit();
-        SDL_Quit();
-        errx(EXIT_FAILURE, "surface_to_grayscale a échoué");
-    }
-
-   // printf("image situé à l'endroit : %s",path);
-    // Reconnaissance
-    char res = letter_recognition(img_pixel);
-
-
-    // Libération complète
-    for (int y = 0; y < TEMPLATE_SIZE; y++) free(img_pixel[y]);
-    free(img_pixel);
-
-    IMG_Quit();
-    SDL_Quit();
-    return res;
+    return ret;
 }
@@ -5,13 +5,14 @@
 #include <stdint.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include "forward_kernel.h"
 
 #ifndef INPUT_SIZE
-#define INPUT_SIZE 784
+#define INPUT_SIZE 1024
 #endif
 
 #ifndef HIDDEN_SIZE
-#define HIDDEN_SIZE 32
+#define HIDDEN_SIZE 128
 #endif
 
 #ifndef OUTPUT_SIZE
@@ -19,11 +20,11 @@
 #endif
 
 #ifndef LEARNING_RATE
-#define LEARNING_RATE 0.1f
+#define LEARNING_RATE 0.01
 #endif
 
 #ifndef MAX_TEMPLATES_PER_LETTER
-#define MAX_TEMPLATES_PER_LETTER 20
+#define MAX_TEMPLATES_PER_LETTER 1300
 #endif
 
 #ifndef TEMPLATE_SIZE
@@ -31,58 +32,92 @@
 #endif
 
 #ifndef EPOCHS
-#define EPOCHS 5
+#define EPOCHS 20
 #endif
 
-extern float input[INPUT_SIZE];
-extern float hidden[HIDDEN_SIZE];
-extern float output[OUTPUT_SIZE];
+#ifndef BATCH_BLOCK
+#define BATCH_BLOCK 32  // lettres traitées ensemble par recognize_batch
+#endif
 
-extern float wIH[INPUT_SIZE][HIDDEN_SIZE];
-extern float bH[HIDDEN_SIZE];
+#ifndef MODEL_DIR
+#define MODEL_DIR "./output"
+#endif
 
-extern float wHO[HIDDEN_SIZE][OUTPUT_SIZE];
-extern float bO[OUTPUT_SIZE];
+#ifndef MODEL_FILE
+#define MODEL_FILE MODEL_DIR "/model.bin"
+#endif
 
+// Réseau en cours d'entrainement : poids modifiables et activations de la lettre courante
+// (un Network par entrainement, plus aucun tableau global)
 typedef struct {
-    SDL_Surface *templates[MAX_TEMPLATES_PER_LETTER];
+    float wIH[INPUT_SIZE][HIDDEN_SIZE];  // poids input-hidden
+    float bH[HIDDEN_SIZE];               // biais hidden
+    float wHO[HIDDEN_SIZE][OUTPUT_SIZE]; // poids hidden-output
+    float bO[OUTPUT_SIZE];               // biais output
+    float input[INPUT_SIZE];
+    float hidden[HIDDEN_SIZE];
+    float output[OUTPUT_SIZE];
+} Network;
+
+typedef struct {
+    float *templates[MAX_TEMPLATES_PER_LETTER];  // INPUT_SIZE niveaux de gris chacun
     int count;
 } LetterTemplates;
 
-extern LetterTemplates letter_templates[26];
-extern int total_templates;
+// Poids du réseau chargés une seule fois, partagés par toutes les reconnaissances
+// Le modèle n'est plus modifié après le chargement : plusieurs threads peuvent l'utiliser
+// en même temps, chaque appel garde ses tampons de calcul sur sa propre pile
+// wHI et wOH sont les transposées de wIH et wHO : une ligne contiguë de poids par neurone
+typedef struct {
+    const float *wHI;   // HIDDEN_SIZE x INPUT_SIZE
+    const float *bH;    // HIDDEN_SIZE
+    const float *wOH;   // OUTPUT_SIZE x HIDDEN_SIZE (wHO transposé)
+    const float *bO;    // OUTPUT_SIZE
+    void *base;         // bloc au format de model.bin qui contient les tableaux
+    size_t map_size;    // taille du mmap, 0 si base vient de malloc
+    const ForwardKernel *kernel;  // noyau de calcul choisi au chargement
+} Model;
 
 void load1D(const char *filename, float *array, int size);
 void load2D(const char *filename, int rows, int cols, float matrix[rows][cols]);
-void loads(void);
-int store_res(void);
+void loads(Network *net);
+int store_res(const Network *net);
+
+Model *model_load(void);
+Model *model_load_text(const char *dir);
+Model *model_alloc(void);
+Model *model_map(const char *path);
+int model_save(const Model *model, const char *path);
+void model_free(Model *model);
+void model_forward(const Model *model, const float *in, float *out);
+void recognize_batch(const Model *model, const float *glyphs, int n, char *out, float *conf);
 
 float random_weight(void);
-void init_weights(void);
+void init_weights(Network *net);
 
 float sigmoid(float x);
 void softmax(float *input, float *output, size_t len);
 
-void calcul_hidden(void);
-void calcul_output(void);
-void forward(void);
+void calcul_hidden(Network *net);
+void calcul_output(Network *net);
+void forward(Network *net);
 
-void calcul_errorO(float *errorO, int index_letter);
-void calcul_errorH(float *errorH, float *errorO);
-void update_HO(float *errorO);
-void update_IH(float *errorH);
-void back_propagation(int index_letter);
+void calcul_errorO(const Network *net, float *errorO, int index_letter);
+void calcul_errorH(const Network *net, float *errorH, float *errorO);
+void update_HO(Network *net, float *errorO);
+void update_IH(Network *net, float *errorH);
+void back_propagation(Network *net, int index_letter);
 
-void training(int index_letter, float **img);
-char recognize_letter(char *path_letter);
-void load_letter_template(const char *dossier);
+void training(Network *net, int index_letter, const float *img);
 
-SDL_Surface *normalize_size(SDL_Surface *img, int target_w, int target_h);
-float **surface_to_grayscale(SDL_Surface *img);
+// Gris (0 noir, 1 blanc) du pixel (x, y) d'une image src, pour glyph_from_rect
+typedef float (*GlyphPixelFn)(const void *src, int x, int y);
+int glyph_from_rect(GlyphPixelFn gray, const void *src, int x, int y, int w, int h, float *glyph);
+int glyph_from_surface(SDL_Surface *img, float *glyph);
+int load_glyph(const char *path, float *glyph);
+int load_letter_template(const char *dossier, LetterTemplates *letter_templates);
 
 int train(void);
-char letter_recognition(float **img);
-
-int is_image_filename(const char *name);
+char letter_recognition(const Model *model, const float *img);
 
 #endif /* TRAINING_H */
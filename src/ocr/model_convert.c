@@ -0,0 +1,37 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <err.h>
+#include "letter_recognition.h"
+#include "model_file.h"
+
+// Convertit les poids texte (wIH.txt, wHO.txt, bH.txt, bO.txt) en fichier binaire model.bin
+// Usage : model_convert [dossier_des_fichiers_texte] [fichier_binaire]
+int main(int argc, char *argv[])
+{
+    const char *dir = (argc > 1) ? argv[1] : MODEL_DIR;
+    const char *out = (argc > 2) ? argv[2] : MODEL_FILE;
+
+    Model *model = model_load_text(dir);
+    if (model_save(model, out) != 0)
+        errx(EXIT_FAILURE, "Erreur : écriture de %s impossible", out);
+
+    // relecture pour vérifier que le fichier est valide et identique
+    Model *check = model_map(out);
+    if (!check)
+        errx(EXIT_FAILURE, "Erreur : %s illisible après écriture", out);
+
+    if (memcmp(model->wHI, check->wHI, (size_t)HIDDEN_SIZE * INPUT_SIZE * sizeof(float)) != 0
+        || memcmp(model->bH, check->bH, HIDDEN_SIZE * sizeof(float)) != 0
+        || memcmp(model->wOH, check->wOH, HIDDEN_SIZE * OUTPUT_SIZE * sizeof(float)) != 0
+        || memcmp(model->bO, check->bO, OUTPUT_SIZE * sizeof(float)) != 0)
+        errx(EXIT_FAILURE, "Erreur : %s ne correspond pas aux fichiers texte", out);
+
+    printf("[OCR] %s/*.txt -> %s (%ux%ux%u, checksum %08x)\n", dir, out,
+           INPUT_SIZE, HIDDEN_SIZE, OUTPUT_SIZE,
+           ((const ModelFileHeader *)check->base)->checksum);
+
+    model_free(check);
+    model_free(model);
+    return 0;
+}
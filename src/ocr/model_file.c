@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "model_file.h"
+
+// arrondit au multiple de MODEL_ALIGN supérieur
+static uint64_t align_up(uint64_t n)
+{
+    return (n + MODEL_ALIGN - 1) / MODEL_ALIGN * MODEL_ALIGN;
+}
+
+// remplit l'en-tête avec la disposition des tableaux dans le fichier
+static void model_layout(ModelFileHeader *h)
+{
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, MODEL_MAGIC, 4);
+    h->version = MODEL_VERSION;
+    h->input_size = INPUT_SIZE;
+    h->hidden_size = HIDDEN_SIZE;
+    h->output_size = OUTPUT_SIZE;
+
+    h->wHI_offset = align_up(sizeof(ModelFileHeader));
+    h->bH_offset = align_up(h->wHI_offset + (uint64_t)HIDDEN_SIZE * INPUT_SIZE * sizeof(float));
+    h->wOH_offset = align_up(h->bH_offset + (uint64_t)HIDDEN_SIZE * sizeof(float));
+    h->bO_offset = align_up(h->wOH_offset + (uint64_t)HIDDEN_SIZE * OUTPUT_SIZE * sizeof(float));
+    h->file_size = align_up(h->bO_offset + (uint64_t)OUTPUT_SIZE * sizeof(float));
+}
+
+// FNV-1a sur des mots de 32 bits (la taille est toujours un multiple de MODEL_ALIGN)
+uint32_t model_checksum(const void *data, size_t size)
+{
+    const uint32_t *p = data;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size / sizeof(uint32_t); i++)
+    {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// fait pointer les tableaux du modèle dans le bloc base
+static void model_bind(Model *model, void *base, const ModelFileHeader *h)
+{
+    char *b = base;
+    model->wHI = (const float *)(b + h->wHI_offset);
+    model->bH = (const float *)(b + h->bH_offset);
+    model->wOH = (const float *)(b + h->wOH_offset);
+    model->bO = (const float *)(b + h->bO_offset);
+    model->base = base;
+    model->kernel = forward_kernel_select();
+}
+
+//alloue un modèle vide avec la même disposition que le fichier binaire
+Model *model_alloc(void)
+{
+    ModelFileHeader h;
+    model_layout(&h);
+
+    Model *model = malloc(sizeof(Model));
+    void *base = aligned_alloc(MODEL_ALIGN, h.file_size);
+    if (!model || !base)
+    {
+        free(model);
+        free(base);
+        return NULL;
+    }
+    memset(base, 0, h.file_size);
+    memcpy(base, &h, sizeof(h));
+
+    model_bind(model, base, &h);
+    model->map_size = 0;
+    return model;
+}
+
+//projette un fichier binaire en mémoire (lecture seule, pages partagées entre processus)
+//renvoie NULL si le fichier est absent ou invalide
+Model *model_map(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ModelFileHeader))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    ModelFileHeader expected;
+    model_layout(&expected);
+    const ModelFileHeader *h = base;
+
+    if (memcmp(h->magic, MODEL_MAGIC, 4) != 0 || h->version != MODEL_VERSION)
+    {
+        fprintf(stderr, "[OCR] %s : format de modèle inconnu\n", path);
+        munmap(base, size);
+        return NULL;
+    }
+    if (h->input_size != INPUT_SIZE || h->hidden_size != HIDDEN_SIZE
+        || h->output_size != OUTPUT_SIZE || h->wHI_offset != expected.wHI_offset
+        || h->bH_offset != expected.bH_offset || h->wOH_offset != expected.wOH_offset
+        || h->bO_offset != expected.bO_offset || h->file_size != size)
+    {
+        fprintf(stderr, "[OCR] %s : dimensions du modèle incompatibles (%ux%ux%u)\n",
+                path, h->input_size, h->hidden_size, h->output_size);
+        munmap(base, size);
+        return NULL;
+    }
+
+    const char *data = (const char *)base + h->wHI_offset;
+    if (model_checksum(data, size - h->wHI_offset) != h->checksum)
+    {
+        fprintf(stderr, "[OCR] %s : checksum invalide\n", path);
+        munmap(base, size);
+        return NULL;
+    }
+
+    Model *model = malloc(sizeof(Model));
+    if (!model)
+    {
+        munmap(base, size);
+        return NULL;
+    }
+    model_bind(model, base, h);
+    model->map_size = size;
+    return model;
+}
+
+//écrit le modèle au format binaire (fichier temporaire puis rename pour rester atomique)
+int model_save(const Model *model, const char *path)
+{
+    ModelFileHeader h;
+    model_layout(&h);
+
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp)
+    {
+        printf("Erreur : impossible d'ouvrir le fichier %s\n", tmp);
+        return -1;
+    }
+
+    // on recopie les tableaux dans un bloc à la disposition du fichier pour calculer le checksum
+    Model *out = model_alloc();
+    if (!out)
+    {
+        fclose(fp);
+        remove(tmp);
+        return -1;
+    }
+    memcpy((float *)out->wHI, model->wHI, (size_t)HIDDEN_SIZE * INPUT_SIZE * sizeof(float));
+    memcpy((float *)out->bH, model->bH, HIDDEN_SIZE * sizeof(float));
+    memcpy((float *)out->wOH, model->wOH, HIDDEN_SIZE * OUTPUT_SIZE * sizeof(float));
+    memcpy((float *)out->bO, model->bO, OUTPUT_SIZE * sizeof(float));
+
+    char *base = out->base;
+    h.checksum = model_checksum(base + h.wHI_offset, h.file_size - h.wHI_offset);
+    memcpy(base, &h, sizeof(h));
+
+    size_t written = fwrite(base, 1, h.file_size, fp);
+    model_free(out);
+    if (fclose(fp) != 0 || written != h.file_size)
+    {
+        remove(tmp);
+        return -1;
+    }
+
+    if (rename(tmp, path) != 0)
+    {
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+//libère le modèle (munmap si le modèle vient d'un fichier binaire)
+void model_free(Model *model)
+{
+    if (!model) return;
+    if (model->map_size > 0) munmap(model->base, model->map_size);
+    else free(model->base);
+    free(model);
+}
@@ -0,0 +1,30 @@
+#ifndef MODEL_FILE_H
+#define MODEL_FILE_H
+
+#include <stdint.h>
+#include "letter_recognition.h"
+
+// Format binaire du modèle : un en-tête suivi des tableaux float (wHI, bH, wOH, bO)
+// alignés sur MODEL_ALIGN octets, utilisables tels quels après un mmap.
+// Version 2 : wHI et wOH sont stockés neurone par neurone (transposées de wIH.txt et wHO.txt).
+#define MODEL_MAGIC "OCRM"
+#define MODEL_VERSION 2
+#define MODEL_ALIGN 64
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t input_size;
+    uint32_t hidden_size;
+    uint32_t output_size;
+    uint32_t checksum;      // FNV-1a sur tout ce qui suit l'en-tête
+    uint64_t wHI_offset;
+    uint64_t bH_offset;
+    uint64_t wOH_offset;
+    uint64_t bO_offset;
+    uint64_t file_size;
+} ModelFileHeader;
+
+uint32_t model_checksum(const void *data, size_t size);
+
+#endif
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include "ocr_session.h"
+
+// IMG_Init/IMG_Quit ne sont pas comptés par SDL_image : on compte ici les
+// sessions ouvertes pour n'initialiser qu'à la première et ne quitter qu'à la dernière
+static pthread_mutex_t img_lock = PTHREAD_MUTEX_INITIALIZER;
+static int img_users = 0;
+
+static int img_acquire(void)
+{
+    int ret = 0;
+    pthread_mutex_lock(&img_lock);
+    if (img_users == 0)
+    {
+        // chargé avant les threads : IMG_Load n'a plus à initialiser les formats en concurrence
+        int img_flags = IMG_INIT_PNG | IMG_INIT_JPG;
+        if ((IMG_Init(img_flags) & img_flags) != img_flags)
+        {
+            fprintf(stderr, "[OCR] IMG_Init failed: %s\n", IMG_GetError());
+            ret = -1;
+        }
+    }
+    if (ret == 0) img_users++;
+    pthread_mutex_unlock(&img_lock);
+    return ret;
+}
+
+static void img_release(void)
+{
+    pthread_mutex_lock(&img_lock);
+    if (--img_users == 0) IMG_Quit();
+    pthread_mutex_unlock(&img_lock);
+}
+
+OcrSession *ocr_session_open(int n_threads)
+{
+    if (img_acquire() != 0) return NULL;
+
+    OcrSession *session = malloc(sizeof(OcrSession));
+    if (!session)
+    {
+        img_release();
+        return NULL;
+    }
+
+    session->model = model_load();
+    session->pool = thread_pool_create(n_threads);
+    return session;
+}
+
+void ocr_session_close(OcrSession *session)
+{
+    if (!session) return;
+
+    thread_pool_destroy(session->pool);
+    model_free(session->model);
+    free(session);
+    img_release();
+}
+
+char ocr_session_recognize(const OcrSession *session, const char *path)
+{
+    float glyph[INPUT_SIZE];
+    if (load_glyph(path, glyph) != 0) return '?';
+
+    char res;
+    recognize_batch(session->model, glyph, 1, &res, NULL);
+    return res;
+}
@@ -0,0 +1,23 @@
+#ifndef OCR_SESSION_H
+#define OCR_SESSION_H
+
+#include "letter_recognition.h"
+#include "../utils/thread_pool.h"
+
+// Session de reconnaissance : tout ce qui ne doit être préparé qu'une fois
+// (SDL_image, modèle, threads) est ouvert par ocr_session_open et gardé jusqu'à
+// ocr_session_close, au lieu d'être réinitialisé à chaque lettre
+typedef struct {
+    Model *model;       // poids partagés, en lecture seule
+    ThreadPool *pool;   // threads pour process_grid
+} OcrSession;
+
+// n_threads <= 0 : taille par défaut du pool (voir thread_pool_default_size)
+// renvoie NULL si SDL_image ne peut pas être initialisé
+OcrSession *ocr_session_open(int n_threads);
+void ocr_session_close(OcrSession *session);
+
+// reconnait une image de lettre, '?' si elle ne peut pas être lue
+char ocr_session_recognize(const OcrSession *session, const char *path);
+
+#endif
@@ -3,102 +3,71 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <dirent.h>
-#include <sys/stat.h>
-#include <unistd.h>
 
 
-# define MAX_N_LETTERS 20
-
-int file_exists(const char *path) {
-    FILE *f = fopen(path, "r");
-    if (f) {
-        fclose(f);
-        return 1;
-    }
-    return 0;
-}
-
-int detect_words_number(const char *words_letters_dir)
-{
-    for(int i=0;i<100;i++)
-    {
-        char path[512];
-        snprintf(path, sizeof(path), "%s/w_%02d.bmp",words_letters_dir, i);
-        printf("%s",path);
-        //test existence de la letter 
-        if (!file_exists(path)) return i;
-    }
-    return 100;
-}
-
-
-// Placeholder for word recognition
-int process_words(const char* words_dir,const char* words_letters_dir, const char* output_file) 
+// Reconnaissance des mots : letters contient les lettres découpées (row = mot, col = lettre)
+// words reçoit au plus max_words mots ; renvoie le nombre de mots, ou -1 si la mémoire manque
+int recognize_words(const Model* model, const GlyphSet* letters, char words[][MAX_N_LETTERS + 1], int max_words) 
 {
     
-    printf("[WORDS] Words dir: %s\n", words_dir);
-    printf("[WORDS] Output: %s\n", output_file);
+    int number_words= letters->rows;
+    if (number_words > max_words) number_words = max_words;
+    printf("[WORDS] %d words found\n",number_words);
     
-    int number_words= detect_words_number(words_dir);
-    printf("[WORDS] %d words found",number_words);
-    
-    // Allocate words
-    char** words = (char**)malloc(number_words * sizeof(char*));
+    // Mots remplis de '\0' : un mot s'arrête à sa dernière lettre
     for (int i = 0; i < number_words; i++) {
-        words[i] = (char*)malloc((MAX_N_LETTERS + 1) * sizeof(char));
-        words[i][MAX_N_LETTERS] = '\0';  // Null terminate each row
+        memset(words[i], 0, MAX_N_LETTERS + 1);
     }
     
 
 
     // Process each letter of each word
-    printf("[GRID] Processing %d words...\n",number_words);
-
-    for (int n_words=0; n_words<number_words; n_words++) {
-        for (int n_letters = 0; n_letters < MAX_N_LETTERS; n_letters++) {
-            char path[512];
-            snprintf(path, sizeof(path), "%s/word_%02d_letter_%02d.bmp",words_letters_dir, n_words, n_letters);
-            //test existence de la letter 
-            if (file_exists(path))
-            {
-                char letter = recognize_letter(path);
-                words[n_words][n_letters] = letter;
-            }
-            else
-            {
-                words[n_words][n_letters] ='\0'; // stop la reconnaisance du mot comme toutes les lettres ont été traitées
-                break;
-            }
-        }
-    }
-
-    printf("[GRID] Recognition complete:\n");
-
-    // Write to file
-    FILE* f = fopen(output_file, "w");
-    if (!f) {
-        fprintf(stderr, "[GRID] ✗ Cannot create output file: %s\n", output_file);
-        for (int i = 0; i < number_words; i++) free(words[i]);
-        free(words);
+    printf("[WORDS] Processing %d words...\n",number_words);
+
+    // Toutes les lettres de tous les mots sont normalisées puis reconnues en un seul lot
+    size_t max_glyphs = (size_t)letters->count;
+    float* glyphs = (float*)malloc(max_glyphs * INPUT_SIZE * sizeof(float));
+    char* res = (char*)malloc(max_glyphs * sizeof(char));
+    const Glyph** slot = (const Glyph**)malloc(max_glyphs * sizeof(Glyph*));
+    if (max_glyphs > 0 && (!glyphs || !res || !slot)) {
+        fprintf(stderr, "[WORDS] ✗ Mémoire insuffisante pour %zu lettres\n", max_glyphs);
+        free(glyphs);
+        free(res);
+        free(slot);
         return -1;
     }
-
-    for (int i = 0; i < number_words; i++) {
-        fprintf(f, "%s\n", words[i]);
+    int n_glyphs = 0;
+
+    for (int i = 0; i < letters->count; i++) {
+        const Glyph* letter = &letters->items[i];
+        if (letter->row >= number_words || letter->col >= MAX_N_LETTERS) continue;
+
+        // Mise à l'échelle lue directement dans l'image de la liste de mots
+        GlyphView view = { letters, letter };
+        SDL_Rect r = letter->rect;
+        if (glyph_from_rect(glyph_gray, &view, r.x, r.y, r.w, r.h, glyphs + (size_t)n_glyphs * INPUT_SIZE) == 0)
+        {
+            slot[n_glyphs++] = letter;
+        }
+        else
+        {
+            words[letter->row][letter->col] ='\0'; // lettre illisible : le mot s'arrête là
+        }
     }
 
+    if (n_glyphs > 0) recognize_batch(model, glyphs, n_glyphs, res, NULL);
 
-    fclose(f);
-
-
-    // Cleanup
-    for (int i = 0; i < number_words; i++) free(words[i]);
-    free(words);
+    for (int i = 0; i < n_glyphs; i++) {
+        char *word = words[slot[i]->row];
+        // une lettre après une lettre illisible ne compte plus
+        if ((int)strlen(word) == slot[i]->col) word[slot[i]->col] = res[i];
+    }
 
-    printf("[GRID] ✓ Words saved to: %s\n", output_file);
+    free(glyphs);
+    free(res);
+    free(slot);
 
+    printf("[WORDS] Recognition complete\n");
 
-    
-    return 0;
+    return number_words;
 }
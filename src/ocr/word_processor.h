@@ -1,6 +1,10 @@
 #ifndef WORD_PROCESSOR_H
 #define WORD_PROCESSOR_H
 
-int detect_words_number(const char *words_letters_dir);
-int process_words(const char* words_dir,const char* words_letters_dir, const char* output_file);
+#include "letter_recognition.h"
+#include "../extraction/glyph_set.h"
+
+#define MAX_N_LETTERS 20
+
+int recognize_words(const Model* model, const GlyphSet* letters, char words[][MAX_N_LETTERS + 1], int max_words);
 #endif
@@ -0,0 +1,254 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <err.h>
+#include <pthread.h>
+#include <SDL2/SDL.h>
+
+#include "pipeline.h"
+#include "../utils/thread_pool.h"
+
+// Headless driver: solves many puzzle images without GTK and writes one JSON
+// object per image and per line, in input order. Each line carries the
+// per-stage timings of that image under "stats".
+//
+// Usage: ocr_batch [-j workers] [-m manifest] [-o out.jsonl] [-b method] [-q] [image.bmp ...]
+//   -j  images solved at the same time (default: $OCR_THREADS or core count)
+//   -b  binarization: isodata (default), sauvola or bradley
+//   -m  file with one image path per line (blank lines and # comments skipped)
+//   -o  JSON lines file (default: stdout)
+//   -q  drop the pipeline logs (default: they go to stderr)
+
+typedef struct {
+    char** paths;
+    int count;
+    int capacity;
+} PathList;
+
+typedef struct {
+    const OcrSession* ocr;
+    PipelineOptions options;
+    const PathList* inputs;
+    FILE* out;
+
+    // results are printed in input order: lines[i] waits until 0..i-1 are out
+    pthread_mutex_t lock;
+    char** lines;
+    int next;
+    int failed;
+
+    // one scratch arena per worker, kept from image to image: idle[0..idle_count)
+    // are the ones no image is using (protected by lock)
+    Arena* arenas;
+    int* idle;
+    int idle_count;
+} BatchJob;
+
+static void path_list_add(PathList* list, const char* path) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->paths = (char**)realloc(list->paths, list->capacity * sizeof(char*));
+        if (!list->paths) errx(EXIT_FAILURE, "[BATCH] Out of memory");
+    }
+    list->paths[list->count] = strdup(path);
+    if (!list->paths[list->count]) errx(EXIT_FAILURE, "[BATCH] Out of memory");
+    list->count++;
+}
+
+static void read_manifest(PathList* list, const char* manifest) {
+    FILE* f = fopen(manifest, "r");
+    if (!f) errx(EXIT_FAILURE, "[BATCH] Cannot open manifest: %s", manifest);
+
+    char line[1024];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = 0;
+        if (line[0] == '\0' || line[0] == '#') continue;
+        path_list_add(list, line);
+    }
+    fclose(f);
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void json_string(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if (c == '\n') fputs("\\n", f);
+        else if (c == '\r') fputs("\\r", f);
+        else if (c == '\t') fputs("\\t", f);
+        else if (c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+// One JSON line for one image (without the trailing newline)
+static char* format_result(const char* image, const PuzzleResult* r, int ok, double ms) {
+    char* line = NULL;
+    size_t size = 0;
+    FILE* f = open_memstream(&line, &size);
+    if (!f) return NULL;
+
+    fputs("{\"image\":", f);
+    json_string(f, image);
+    if (!ok) {
+        fputs(",\"ok\":false,\"error\":", f);
+        json_string(f, r ? r->error : "Out of memory");
+        fprintf(f, ",\"ms\":%.1f", ms);
+        if (r) {
+            fputs(",\"stats\":", f);
+            stats_write_json(&r->stats, f);
+        }
+        fputc('}', f);
+        fclose(f);
+        return line;
+    }
+
+    fprintf(f, ",\"ok\":true,\"rows\":%d,\"cols\":%d,\"grid\":[", r->grid.rows, r->grid.cols);
+    for (int y = 0; y < r->grid.rows; y++) {
+        if (y) fputc(',', f);
+        json_string(f, r->grid.cells[y]);
+    }
+    fputs("],\"words\":[", f);
+    for (int i = 0; i < r->word_count; i++) {
+        if (i) fputc(',', f);
+        fputs("{\"word\":", f);
+        json_string(f, r->words[i]);
+        if (r->found[i])
+            fprintf(f, ",\"found\":true,\"start\":[%d,%d],\"end\":[%d,%d]}",
+                    r->pos[i].x0, r->pos[i].y0, r->pos[i].x1, r->pos[i].y1);
+        else
+            fputs(",\"found\":false}", f);
+    }
+    fprintf(f, "],\"found\":%d,\"total\":%d,\"ms\":%.1f,\"stats\":", r->found_count, r->word_count, ms);
+    stats_write_json(&r->stats, f);
+    fputc('}', f);
+    fclose(f);
+    return line;
+}
+
+static void solve_image(void* arg, int task) {
+    BatchJob* job = (BatchJob*)arg;
+    const char* image = job->inputs->paths[task];
+
+    pthread_mutex_lock(&job->lock);
+    int arena = job->idle[--job->idle_count];
+    pthread_mutex_unlock(&job->lock);
+    PipelineOptions options = job->options;
+    options.scratch = &job->arenas[arena];
+
+    double t0 = now_ms();
+    PuzzleResult* result = (PuzzleResult*)malloc(sizeof(PuzzleResult));
+    int ok = result && pipeline_solve(job->ocr, image, &options, result) == 0;
+    char* line = format_result(image, result, ok, now_ms() - t0);
+    free(result);
+
+    pthread_mutex_lock(&job->lock);
+    job->idle[job->idle_count++] = arena;
+    job->lines[task] = line ? line : strdup("{\"ok\":false,\"error\":\"Out of memory\"}");
+    if (!ok) job->failed++;
+
+    // flush every finished line at the head of the queue
+    while (job->next < job->inputs->count && job->lines[job->next]) {
+        fprintf(job->out, "%s\n", job->lines[job->next]);
+        free(job->lines[job->next]);
+        job->lines[job->next] = (char*)"";
+        job->next++;
+    }
+    fflush(job->out);
+    pthread_mutex_unlock(&job->lock);
+}
+
+int main(int argc, char* argv[]) {
+    PathList inputs = { NULL, 0, 0 };
+    const char* out_path = NULL;
+    int workers = 0;
+    int quiet = 0;
+    BinarizeMethod binarize = BINARIZE_ISODATA;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:m:o:b:q")) != -1) {
+        switch (opt) {
+            case 'j': workers = atoi(optarg); break;
+            case 'm': read_manifest(&inputs, optarg); break;
+            case 'o': out_path = optarg; break;
+            case 'b':
+                if (binarize_method_parse(optarg, &binarize) != 0)
+                    errx(EXIT_FAILURE, "[BATCH] Unknown binarization method: %s", optarg);
+                break;
+            case 'q': quiet = 1; break;
+            default:
+                errx(EXIT_FAILURE, "Usage: %s [-j workers] [-m manifest] [-o out.jsonl] [-b method] [-q] [image.bmp ...]", argv[0]);
+        }
+    }
+    for (int i = optind; i < argc; i++) path_list_add(&inputs, argv[i]);
+    if (inputs.count == 0)
+        errx(EXIT_FAILURE, "Usage: %s [-j workers] [-m manifest] [-o out.jsonl] [-b method] [-q] [image.bmp ...]", argv[0]);
+
+    if (workers <= 0) workers = thread_pool_default_size();
+    if (workers > inputs.count) workers = inputs.count;
+
+    // stdout belongs to the JSON lines: the pipeline logs go to stderr (or nowhere)
+    FILE* out = out_path ? fopen(out_path, "w") : fdopen(dup(STDOUT_FILENO), "w");
+    if (!out) errx(EXIT_FAILURE, "[BATCH] Cannot open output: %s", out_path ? out_path : "stdout");
+    fflush(stdout);
+    int log_fd = quiet ? open("/dev/null", O_WRONLY) : dup(STDERR_FILENO);
+    dup2(log_fd, STDOUT_FILENO);
+    close(log_fd);
+
+    if (SDL_Init(0) != 0) errx(EXIT_FAILURE, "[BATCH] SDL Init Error: %s", SDL_GetError());
+
+    // One recognizer for every image; parallelism comes from solving several images
+    // at once, so the session keeps no pool of its own (a task of the image pool
+    // must not wait on that same pool)
+    OcrSession* ocr = ocr_session_open(1);
+    if (!ocr) errx(EXIT_FAILURE, "[BATCH] Cannot open recognition session");
+    ThreadPool* pool = thread_pool_create(workers);
+
+    BatchJob job;
+    job.ocr = ocr;
+    memset(&job.options, 0, sizeof(job.options));
+    job.options.binarize = binarize;
+    job.inputs = &inputs;
+    job.out = out;
+    pthread_mutex_init(&job.lock, NULL);
+    job.lines = (char**)calloc(inputs.count, sizeof(char*));
+    job.next = 0;
+    job.failed = 0;
+    job.arenas = (Arena*)calloc(workers, sizeof(Arena));
+    job.idle = (int*)calloc(workers, sizeof(int));
+    if (!job.lines || !job.arenas || !job.idle) errx(EXIT_FAILURE, "[BATCH] Out of memory");
+    for (int i = 0; i < workers; i++) job.idle[i] = i;
+    job.idle_count = workers;
+
+    double t0 = now_ms();
+    thread_pool_run(pool, inputs.count, solve_image, &job);
+    double total_ms = now_ms() - t0;
+
+    fprintf(stderr, "[BATCH] %d images, %d failed, %d workers, %.1f ms (%.1f ms/image)\n",
+            inputs.count, job.failed, workers, total_ms, total_ms / inputs.count);
+
+    int failed = job.failed;
+    pthread_mutex_destroy(&job.lock);
+    free(job.lines);
+    for (int i = 0; i < workers; i++) arena_free(&job.arenas[i]);
+    free(job.arenas);
+    free(job.idle);
+    thread_pool_destroy(pool);
+    ocr_session_close(ocr);
+    SDL_Quit();
+    fclose(out);
+    for (int i = 0; i < inputs.count; i++) free(inputs.paths[i]);
+    free(inputs.paths);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
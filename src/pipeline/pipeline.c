@@ -0,0 +1,294 @@
+#include "pipeline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <SDL2/SDL.h>
+
+#include "../extraction/extract_grid.h"
+#include "../extraction/slice_grid.h"
+#include "../extraction/slice_grid_no_lines.h"
+#include "../extraction/trim_cells.h"
+#include "../extraction/extract_wordlist.h"
+#include "../extraction/slice_words.h"
+#include "../extraction/slice_letter_word.h"
+#include "../extraction/trim_word_letters.h"
+#include "../ocr/grid_processor.h"
+
+// Scratch memory reserved per pixel of the page before extraction: the
+// sample pages peak under 2, and the arena grows past it anyway if needed
+#define SCRATCH_BYTES_PER_PIXEL 4
+
+static void dump_surface(const PipelineOptions* options, PipelineStats* stats,
+                         SDL_Surface* s, const char* name) {
+    if (!options || !options->dump_dir) return;
+    char path[512];
+    mkdir(options->dump_dir, 0755);
+    snprintf(path, sizeof(path), "%s/%s", options->dump_dir, name);
+    if (SDL_SaveBMP(s, path) != 0) return;
+    stats_file_written(stats, path);
+    printf("  ✓ Saved: %s\n", path);
+}
+
+// Surfaces are only built for the dump
+static void dump_bitmap(const PipelineOptions* options, PipelineStats* stats,
+                        const Bitmap* bm, const char* name) {
+    if (!options || !options->dump_dir) return;
+    SDL_Surface* s = bitmap_to_surface(bm, 0, 0, bm->w, bm->h);
+    if (!s) return;
+    dump_surface(options, stats, s, name);
+    SDL_FreeSurface(s);
+}
+
+static void dump_set(const PipelineOptions* options, PipelineStats* stats,
+                     const GlyphSet* set, const char* subdir, const char* name_fmt) {
+    if (!options || !options->dump_dir || !options->dump_glyphs) return;
+    char dir[512];
+    mkdir(options->dump_dir, 0755);
+    snprintf(dir, sizeof(dir), "%s/%s", options->dump_dir, subdir);
+    stats->files_written += glyph_set_save(set, dir, name_fmt, &stats->bytes_written);
+    printf("  ✓ Saved: %s/\n", dir);
+}
+
+// Scratch memory to reserve for a w x h page
+static size_t scratch_size(int w, int h) {
+    return (size_t)w * h * SCRATCH_BYTES_PER_PIXEL;
+}
+
+// Phase 1: image -> trimmed cells and word letters
+static int extract(const OcrSession* ocr, const char* image_path, const PipelineOptions* options,
+                   Arena* scratch, GlyphSet* cells, GlyphSet* letters, PuzzleResult* result) {
+    PipelineStats* stats = &result->stats;
+
+    // Step 1: Binarize
+    printf("\n[1/8] Binarizing image...\n");
+    StageClock t = stats_begin(ocr->pool);
+    stats_file_read(stats, image_path);
+    SDL_Surface* binary = binarize_image(image_path, options ? options->binarize : BINARIZE_ISODATA, ocr->pool);
+    // The page-level stages read its ink plane, packed once here into the
+    // scratch memory of this image (every stage hands back what it takes)
+    Bitmap page;
+    if (binary) arena_reset(scratch, scratch_size(binary->w, binary->h));
+    int packed = binary ? bitmap_from_surface_in(&page, binary, scratch) : -1;
+    stats_end(stats, STAGE_BINARIZE, t);
+    if (packed != 0) {
+        SDL_FreeSurface(binary);
+        result->error = "Binarization failed";
+        return -1;
+    }
+    dump_surface(options, stats, binary, "binary.bmp");
+    SDL_FreeSurface(binary);
+
+    // Step 2: Extract grid
+    printf("\n[2/8] Extracting puzzle grid...\n");
+    int grid_x, grid_y, grid_w, grid_h;
+    // The grid is cut into scratch, and read from there by the slicers
+    Bitmap grid;
+    ArenaMark grid_mark = arena_mark(scratch);
+    t = stats_begin(ocr->pool);
+    int located = extract_grid_bitmap(&page, &grid, &grid_x, &grid_y, &grid_w, &grid_h, ocr->pool, scratch);
+    stats_end(stats, STAGE_EXTRACT_GRID, t);
+    if (located != 0) {
+        bitmap_free(&page);
+        result->error = "Grid extraction failed";
+        return -1;
+    }
+    printf("  ✓ Grid region: (%d,%d) size %dx%d\n", grid_x, grid_y, grid_w, grid_h);
+    dump_bitmap(options, stats, &grid, "grid.bmp");
+
+    // Step 3: Slice grid into cells
+    printf("\n[3/8] Slicing grid into cells...\n");
+
+    // Essayer d'abord la méthode "avec quadrillage"
+    t = stats_begin(ocr->pool);
+    int slice_res = slice_grid(&grid, cells, ocr->pool, scratch);
+    if (slice_res != 0) {
+        printf("   ! Grid lines not found, trying 'No-Line' extraction method...\n");
+        // Si ça échoue, essayer la méthode "sans quadrillage"
+        glyph_set_free(cells);
+        slice_res = slice_grid_no_lines(&grid, cells, scratch);
+    }
+    stats_end(stats, STAGE_SLICE_GRID, t);
+    // the cells keep their own copy
+    bitmap_free(&grid);
+    arena_release(scratch, grid_mark);
+    if (slice_res != 0) {
+        bitmap_free(&page);
+        result->error = "Grid slicing failed";
+        return -1;
+    }
+    printf("  ✓ Cells: %d (%dx%d)\n", cells->count, cells->rows, cells->cols);
+
+    // Step 4: Trim cells
+    printf("\n[4/8] Trimming cell whitespace...\n");
+    t = stats_begin(ocr->pool);
+    int trim_res = trim_cells(cells);
+    stats_end(stats, STAGE_TRIM_CELLS, t);
+    if (trim_res != 0) {
+        bitmap_free(&page);
+        result->error = "Cell trimming failed";
+        return -1;
+    }
+    dump_set(options, stats, cells, "cells", "c_%02d_%02d.bmp");
+
+    // Step 5: Extract word list
+    printf("\n[5/8] Extracting word list...\n");
+    int wl_x, wl_y, wl_w, wl_h;
+    Bitmap wordlist;
+    t = stats_begin(ocr->pool);
+    int wl_res = extract_wordlist_bitmap(&page, grid_x, grid_y, grid_w, grid_h, &wordlist,
+                                         &wl_x, &wl_y, &wl_w, &wl_h, scratch);
+    stats_end(stats, STAGE_WORDLIST, t);
+    bitmap_free(&page);
+    if (wl_res != 0) {
+        result->error = "Word list extraction failed";
+        return -1;
+    }
+    printf("  ✓ Word list region: (%d,%d) size %dx%d\n", wl_x, wl_y, wl_w, wl_h);
+    dump_bitmap(options, stats, &wordlist, "solvingwords.bmp");
+
+    // Step 6: Slice word list
+    printf("\n[6/8] Slicing word list...\n");
+    GlyphSet words;
+    glyph_set_init(&words);
+    t = stats_begin(ocr->pool);
+    int words_res = slice_words(&wordlist, &words, scratch);
+    stats_end(stats, STAGE_SLICE_WORDS, t);
+    bitmap_free(&wordlist);
+    if (words_res != 0) {
+        glyph_set_free(&words);
+        result->error = "Word slicing failed";
+        return -1;
+    }
+    printf("  ✓ Words: %d\n", words.count);
+    dump_set(options, stats, &words, "words", "w_%02d.bmp");
+
+    // Step 7: Slice word letters
+    printf("\n[7/8] Slicing word letters...\n");
+    t = stats_begin(ocr->pool);
+    int letters_res = slice_word_letters(&words, letters, scratch);
+    stats_end(stats, STAGE_SLICE_LETTERS, t);
+    glyph_set_free(&words);
+    if (letters_res != 0) {
+        result->error = "Word letter slicing failed";
+        return -1;
+    }
+    printf("  ✓ Letters: %d\n", letters->count);
+
+    // Step 8: Trim word letters
+    printf("\n[8/8] Trimming word letter whitespace...\n");
+    t = stats_begin(ocr->pool);
+    trim_res = trim_word_letters(letters);
+    stats_end(stats, STAGE_TRIM_LETTERS, t);
+    if (trim_res != 0) {
+        result->error = "Word letter trimming failed";
+        return -1;
+    }
+    dump_set(options, stats, letters, "word_letters", "word_%02d_letter_%02d.bmp");
+
+    return 0;
+}
+
+// Phase 3: look for every recognized word in the recognized grid
+static void solve(PuzzleResult* result) {
+    result->found_count = 0;
+    for (int i = 0; i < result->word_count; i++) {
+        WordPos* p = &result->pos[i];
+        result->found[i] = find_word(&result->grid, result->words[i], &p->x0, &p->y0, &p->x1, &p->y1);
+        if (result->found[i]) result->found_count++;
+    }
+}
+
+int pipeline_solve(const OcrSession* ocr, const char* image_path,
+                   const PipelineOptions* options, PuzzleResult* result) {
+    memset(result, 0, sizeof(*result));
+    stats_init(&result->stats);
+
+    GlyphSet cells, letters;
+    glyph_set_init(&cells);
+    glyph_set_init(&letters);
+
+    // Without an arena from the caller, one for this image only
+    Arena own;
+    arena_init(&own, 0);
+    Arena* scratch = options && options->scratch ? options->scratch : &own;
+    long mallocs = scratch->heap_allocs;
+
+    // Phase 1: Extraction
+    int extracted = extract(ocr, image_path, options, scratch, &cells, &letters, result);
+    result->stats.scratch_bytes = (long)scratch->peak;
+    result->stats.scratch_mallocs = (int)(scratch->heap_allocs - mallocs);
+    arena_free(&own);
+    if (extracted != 0) {
+        fprintf(stderr, "✗ %s\n", result->error);
+        glyph_set_free(&cells);
+        glyph_set_free(&letters);
+        return -1;
+    }
+    printf("\n✓ Extraction phase complete!\n");
+
+    // Phase 2: OCR
+    StageClock t = stats_begin(ocr->pool);
+    int ret = recognize_grid(ocr->model, ocr->pool, &cells, &result->grid);
+    stats_end(&result->stats, STAGE_OCR_GRID, t);
+    if (ret == 0) {
+        result->stats.glyphs_classified += cells.count;
+
+        t = stats_begin(ocr->pool);
+        int n = recognize_words(ocr->model, &letters, result->words, PIPELINE_MAX_WORDS);
+        stats_end(&result->stats, STAGE_OCR_WORDS, t);
+        if (n < 0) ret = -1;
+        result->stats.glyphs_classified += letters.count;
+
+        // Keep only non-empty words, in order
+        result->word_count = 0;
+        for (int i = 0; i < n; i++) {
+            if (result->words[i][0] == '\0') continue;
+            if (result->word_count != i)
+                memcpy(result->words[result->word_count], result->words[i], MAX_N_LETTERS + 1);
+            result->word_count++;
+        }
+    }
+    glyph_set_free(&cells);
+    glyph_set_free(&letters);
+
+    if (ret != 0) {
+        result->error = "OCR failed";
+        fprintf(stderr, "✗ %s\n", result->error);
+        return -1;
+    }
+    printf("\n✓ OCR phase complete!\n");
+
+    // Phase 3: Solve puzzle
+    t = stats_begin(ocr->pool);
+    solve(result);
+    stats_end(&result->stats, STAGE_SOLVE, t);
+    return 0;
+}
+
+int pipeline_write_outputs(PuzzleResult* result, const char* grid_file, const char* words_file) {
+    FILE* f = fopen(grid_file, "w");
+    if (!f) {
+        fprintf(stderr, "[GRID] ✗ Cannot create output file: %s\n", grid_file);
+        return -1;
+    }
+    for (int i = 0; i < result->grid.rows; i++) {
+        fprintf(f, "%s\n", result->grid.cells[i]);
+    }
+    fclose(f);
+    stats_file_written(&result->stats, grid_file);
+    printf("[GRID] ✓ Grid saved to: %s\n", grid_file);
+
+    f = fopen(words_file, "w");
+    if (!f) {
+        fprintf(stderr, "[WORDS] ✗ Cannot create output file: %s\n", words_file);
+        return -1;
+    }
+    for (int i = 0; i < result->word_count; i++) {
+        fprintf(f, "%s\n", result->words[i]);
+    }
+    fclose(f);
+    stats_file_written(&result->stats, words_file);
+    printf("[WORDS] ✓ Words saved to: %s\n", words_file);
+    return 0;
+}
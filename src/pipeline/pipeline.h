@@ -0,0 +1,49 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "../solver/solver.h"
+#include "../ocr/ocr_session.h"
+#include "../ocr/word_processor.h"
+#include "pipeline_stats.h"
+#include "../extraction/preprocess.h"
+#include "../utils/arena.h"
+
+#define PIPELINE_MAX_WORDS 100
+
+// Everything the pipeline found for one puzzle image
+typedef struct {
+    Grid grid;                                          // recognized letters
+    int word_count;
+    char words[PIPELINE_MAX_WORDS][MAX_N_LETTERS + 1];  // recognized word list
+    int found[PIPELINE_MAX_WORDS];                      // 1 if words[i] is in the grid
+    WordPos pos[PIPELINE_MAX_WORDS];                    // its start/end cell (x = column)
+    int found_count;
+    const char* error;  // failed step ("Grid extraction failed", ...), NULL on success
+    PipelineStats stats;  // per-stage timings and I/O counters, filled even on failure
+} PuzzleResult;
+
+typedef struct {
+    // When set, binary.bmp, grid.bmp and solvingwords.bmp are written there
+    const char* dump_dir;
+    // Also write every sliced image to dump_dir/cells, words and word_letters
+    int dump_glyphs;
+    // Global (ISODATA) or adaptive threshold for step 1
+    BinarizeMethod binarize;
+    // Work memory of the extraction stages, reset at the start of each image
+    // and grown to the most an image needed: a caller solving many images on
+    // one thread keeps it between them. NULL: an arena for this image only.
+    Arena* scratch;
+} PipelineOptions;
+
+// Runs binarize -> extract grid -> slice -> trim -> word list -> OCR -> solve
+// on one BMP image, without GTK and without touching disk (unless dump_dir).
+// The session may be shared by several threads. Returns 0, or -1 with
+// result->error set.
+int pipeline_solve(const OcrSession* ocr, const char* image_path,
+                   const PipelineOptions* options, PuzzleResult* result);
+
+// Writes grid.txt / words.txt in the format read by the solver and result window
+// (counted in result->stats)
+int pipeline_write_outputs(PuzzleResult* result, const char* grid_file, const char* words_file);
+
+#endif
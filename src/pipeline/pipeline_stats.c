@@ -0,0 +1,127 @@
+#include "pipeline_stats.h"
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+static const char* stage_names[STAGE_COUNT] = {
+    "binarize",
+    "extract_grid",
+    "slice_grid",
+    "trim_cells",
+    "wordlist",
+    "slice_words",
+    "slice_letters",
+    "trim_letters",
+    "ocr_grid",
+    "ocr_words",
+    "solve"
+};
+
+static double clock_ms(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static long file_size(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : 0;
+}
+
+void stats_init(PipelineStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+// The calling thread only: other threads of the process may be solving other
+// images. The pool workers are counted by the pool itself.
+static double stage_cpu_ms(ThreadPool* pool) {
+    return clock_ms(CLOCK_THREAD_CPUTIME_ID) + thread_pool_worker_cpu_ms(pool);
+}
+
+StageClock stats_begin(ThreadPool* pool) {
+    StageClock start;
+    start.wall_ms = clock_ms(CLOCK_MONOTONIC);
+    start.cpu_ms = stage_cpu_ms(pool);
+    start.pool = pool;
+    return start;
+}
+
+void stats_end(PipelineStats* stats, PipelineStage stage, StageClock start) {
+    StageTime* t = &stats->stages[stage];
+    t->wall_ms += clock_ms(CLOCK_MONOTONIC) - start.wall_ms;
+    t->cpu_ms += stage_cpu_ms(start.pool) - start.cpu_ms;
+    t->runs++;
+}
+
+void stats_file_read(PipelineStats* stats, const char* path) {
+    stats->bytes_read += file_size(path);
+}
+
+void stats_file_written(PipelineStats* stats, const char* path) {
+    stats->files_written++;
+    stats->bytes_written += file_size(path);
+}
+
+const char* stats_stage_name(PipelineStage stage) {
+    return ((unsigned)stage < STAGE_COUNT) ? stage_names[stage] : "?";
+}
+
+static void totals(const PipelineStats* stats, double* wall_ms, double* cpu_ms) {
+    *wall_ms = 0;
+    *cpu_ms = 0;
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        *wall_ms += stats->stages[s].wall_ms;
+        *cpu_ms += stats->stages[s].cpu_ms;
+    }
+}
+
+void stats_write_json(const PipelineStats* stats, FILE* f) {
+    fputs("{\"stages\":{", f);
+    int first = 1;
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        const StageTime* t = &stats->stages[s];
+        if (!t->runs) continue;
+        fprintf(f, "%s\"%s\":{\"wall_ms\":%.3f,\"cpu_ms\":%.3f}",
+                first ? "" : ",", stage_names[s], t->wall_ms, t->cpu_ms);
+        first = 0;
+    }
+
+    double wall_ms, cpu_ms;
+    totals(stats, &wall_ms, &cpu_ms);
+    fprintf(f, "},\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"files_written\":%d,"
+               "\"bytes_read\":%ld,\"bytes_written\":%ld,\"glyphs\":%d,"
+               "\"scratch_bytes\":%ld,\"scratch_mallocs\":%d}",
+            wall_ms, cpu_ms, stats->files_written,
+            stats->bytes_read, stats->bytes_written, stats->glyphs_classified,
+            stats->scratch_bytes, stats->scratch_mallocs);
+}
+
+int stats_save_json(const PipelineStats* stats, const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "[STATS] ✗ Cannot create report: %s\n", path);
+        return -1;
+    }
+    stats_write_json(stats, f);
+    fputc('\n', f);
+    fclose(f);
+    printf("[STATS] ✓ Report saved to: %s\n", path);
+    return 0;
+}
+
+void stats_print(const PipelineStats* stats) {
+    double wall_ms, cpu_ms;
+    totals(stats, &wall_ms, &cpu_ms);
+
+    printf("\n[STATS] %-14s %10s %10s %6s\n", "stage", "wall ms", "cpu ms", "%");
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        const StageTime* t = &stats->stages[s];
+        if (!t->runs) continue;
+        printf("[STATS] %-14s %10.2f %10.2f %5.1f%%\n", stage_names[s],
+               t->wall_ms, t->cpu_ms, wall_ms > 0 ? 100.0 * t->wall_ms / wall_ms : 0.0);
+    }
+    printf("[STATS] %-14s %10.2f %10.2f\n", "total", wall_ms, cpu_ms);
+    printf("[STATS] glyphs: %d, files written: %d, bytes read: %ld, bytes written: %ld\n",
+           stats->glyphs_classified, stats->files_written, stats->bytes_read, stats->bytes_written);
+    printf("[STATS] scratch: %ld bytes at most, %d mallocs\n", stats->scratch_bytes, stats->scratch_mallocs);
+}
@@ -0,0 +1,72 @@
+#ifndef PIPELINE_STATS_H
+#define PIPELINE_STATS_H
+
+#include <stdio.h>
+#include "../utils/thread_pool.h"
+
+// Stages of pipeline_solve, in execution order
+typedef enum {
+    STAGE_BINARIZE,
+    STAGE_EXTRACT_GRID,
+    STAGE_SLICE_GRID,
+    STAGE_TRIM_CELLS,
+    STAGE_WORDLIST,
+    STAGE_SLICE_WORDS,
+    STAGE_SLICE_LETTERS,
+    STAGE_TRIM_LETTERS,
+    STAGE_OCR_GRID,
+    STAGE_OCR_WORDS,
+    STAGE_SOLVE,
+    STAGE_COUNT
+} PipelineStage;
+
+typedef struct {
+    double wall_ms;
+    double cpu_ms;      // CPU time of the thread running the pipeline, plus what the
+                        // workers of its pool spent on the stage: images solved at
+                        // the same time (ocr_batch -j N) are not counted
+    int runs;           // 0 if the pipeline stopped before this stage
+} StageTime;
+
+// Timings and counters of one pipeline run
+typedef struct {
+    StageTime stages[STAGE_COUNT];
+    int files_written;
+    long bytes_read;
+    long bytes_written;
+    int glyphs_classified;
+    long scratch_bytes;     // most scratch memory the extraction held at once
+    int scratch_mallocs;    // heap allocations the scratch arena made for it
+} PipelineStats;
+
+// Start of a timed section, passed back to stats_end
+typedef struct {
+    double wall_ms;
+    double cpu_ms;
+    ThreadPool* pool;
+} StageClock;
+
+void stats_init(PipelineStats* stats);
+
+// pool: the one the stage runs its jobs on (NULL if none), whose workers' CPU
+// time is added to the stage. It must not serve another image meanwhile.
+StageClock stats_begin(ThreadPool* pool);
+void stats_end(PipelineStats* stats, PipelineStage stage, StageClock start);
+
+// Counts path as read / written, using its size on disk
+void stats_file_read(PipelineStats* stats, const char* path);
+void stats_file_written(PipelineStats* stats, const char* path);
+
+const char* stats_stage_name(PipelineStage stage);
+
+// Report as one JSON object (no trailing newline):
+// {"stages":{"binarize":{"wall_ms":..,"cpu_ms":..},..},"wall_ms":..,"cpu_ms":..,
+//  "files_written":..,"bytes_read":..,"bytes_written":..,"glyphs":..,
+//  "scratch_bytes":..,"scratch_mallocs":..}
+void stats_write_json(const PipelineStats* stats, FILE* f);
+int stats_save_json(const PipelineStats* stats, const char* path);
+
+// Human-readable table for the logs
+void stats_print(const PipelineStats* stats);
+
+#endif
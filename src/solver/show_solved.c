@@ -37,8 +37,10 @@ int main(int argc, char *argv[])
     const char *grid_file  = argv[1];
     const char *words_file = argv[2];
 
-    /* 1) Load grid into global grid[][], rows, cols */
-    read_grid(grid_file);
+    /* 1) Load grid */
+    Grid grid;
+    read_grid(grid_file, &grid);
+    int rows = grid.rows, cols = grid.cols;
 
     /* 2) Allocate mark[y][x] = 1 if cell is in any found word */
     int **mark = malloc(rows * sizeof(int *));
@@ -104,7 +106,7 @@ int main(int argc, char *argv[])
     printf("\nSolved grid:\n\n");
     for (int y = 0; y < rows; y++) {
         for (int x = 0; x < cols; x++) {
-            char c = grid[y][x];
+            char c = grid.cells[y][x];
             if (mark[y][x])
                  printf("%s %c %s", YELLOW_BG, c, RESET);  /* Highlight found letters */
             else
@@ -5,22 +5,16 @@
 #include <ctype.h>
 #include <err.h>
 
-#define MAX_ROWS 100
-#define MAX_COLS 100
 
-char grid[MAX_ROWS][MAX_COLS];
-int rows, cols;
-
-
-void read_grid(const char *filename) {
+void read_grid(const char *filename, Grid *g) {
     FILE *file = fopen(filename, "r");
     if (!file) {
         errx(EXIT_FAILURE, "Error opening file");
     }
 
     char line[MAX_COLS + 2];
-    rows = 0;
-    cols = 0;
+    g->rows = 0;
+    g->cols = 0;
     
     while (fgets(line, sizeof(line), file)) {
         line[strcspn(line, "\n")] = '\0';
@@ -28,39 +22,39 @@ void read_grid(const char *filename) {
         // Skip empty lines
         if (strlen(line) == 0) continue;
         
-        strcpy(grid[rows], line);
-        if (cols == 0)
-            cols = strlen(line);
-        rows++;
+        strcpy(g->cells[g->rows], line);
+        if (g->cols == 0)
+            g->cols = strlen(line);
+        g->rows++;
         
-        if (rows >= MAX_ROWS) break;
+        if (g->rows >= MAX_ROWS) break;
     }
     fclose(file);
 }
 
-int check_word_in_direction(const char *word, int sx, int sy, int dx, int dy) {
+int check_word_in_direction(const Grid *g, const char *word, int sx, int sy, int dx, int dy) {
     int len = strlen(word);
     for (int i = 0; i < len; i++) {
         int x = sx + i * dx;
         int y = sy + i * dy;
-        if (x < 0 || x >= rows || y < 0 || y >= cols || toupper(grid[x][y]) != toupper(word[i]))
+        if (x < 0 || x >= g->rows || y < 0 || y >= g->cols || toupper(g->cells[x][y]) != toupper(word[i]))
             return 0;
     }
     return 1;
 }
 
-int find_word(char word[], int *x, int *y, int *x1, int *y1) {
+int find_word(const Grid *g, const char word[], int *x, int *y, int *x1, int *y1) {
     int directions[8][2] = {
         {0, 1}, {0, -1}, {1, 0}, {-1, 0},
         {1, 1}, {1, -1}, {-1, 1}, {-1, -1}
     };
     
-    for (int r = 0; r < rows; r++) {
-        for (int c = 0; c < cols; c++) {
-            if (toupper(grid[r][c]) == toupper(word[0])) {
+    for (int r = 0; r < g->rows; r++) {
+        for (int c = 0; c < g->cols; c++) {
+            if (toupper(g->cells[r][c]) == toupper(word[0])) {
                 for (int d = 0; d < 8; d++) {
                     int dx = directions[d][0], dy = directions[d][1];
-                    if (check_word_in_direction(word, r, c, dx, dy)) {
+                    if (check_word_in_direction(g, word, r, c, dx, dy)) {
                         *x = c; *y = r;
                         *x1 = c + (strlen(word)-1) * dy;
                         *y1 = r + (strlen(word)-1) * dx;
@@ -80,17 +74,18 @@ int find_word(char word[], int *x, int *y, int *x1, int *y1) {
         return 1;
     }
     
-    read_grid(argv[1]);
+    Grid g;
+    read_grid(argv[1], &g);
     char word[256]; strcpy(word, argv[2]);
     
     int dirs[8][2] = {{0,1},{0,-1},{1,0},{-1,0},{1,1},{1,-1},{-1,1},{-1,-1}};
     
-    for (int r = 0; r < rows; r++) {
-        for (int c = 0; c < cols; c++) {
-            if (toupper(grid[r][c]) == toupper(word[0])) {
+    for (int r = 0; r < g.rows; r++) {
+        for (int c = 0; c < g.cols; c++) {
+            if (toupper(g.cells[r][c]) == toupper(word[0])) {
                 for (int d = 0; d < 8; d++) {
                     int dx = dirs[d][0], dy = dirs[d][1];
-                    if (check_word_in_direction(word, r, c, dx, dy)) {
+                    if (check_word_in_direction(&g, word, r, c, dx, dy)) {
                         int len = strlen(word) - 1;
                         printf("(%d,%d)(%d,%d)\n", c, r, c + len * dy, r + len * dx);
                         return 0;
@@ -9,20 +9,23 @@
 #define MAX_ROWS 100
 #define MAX_COLS 100
 
-extern char grid[MAX_ROWS][MAX_COLS];
-extern int rows;
-extern int cols;
+// Grid of letters read from grid.txt, owned by the caller (no global state)
+typedef struct {
+    char cells[MAX_ROWS][MAX_COLS + 1];
+    int rows;
+    int cols;
+} Grid;
 
 typedef struct {
     int x0, y0;
     int x1, y1;
 } WordPos;
 
-void read_grid(const char *filename);
+void read_grid(const char *filename, Grid *g);
 
-int check_word_in_direction(const char *word, int sx, int sy, int dx, int dy);
+int check_word_in_direction(const Grid *g, const char *word, int sx, int sy, int dx, int dy);
 
-int find_word(char word[], int *x0, int *y0, int *x1, int *y1);
+int find_word(const Grid *g, const char word[], int *x0, int *y0, int *x1, int *y1);
 
 #endif
 
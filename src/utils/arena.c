@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_ALIGN 64
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t size;            // bytes counted in overflow_used
+};
+
+static size_t align_up(size_t n)
+{
+    return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static void note_peak(Arena *arena)
+{
+    size_t held = arena->used + arena->overflow_used;
+    if (held > arena->peak)
+        arena->peak = held;
+}
+
+int arena_init(Arena *arena, size_t size)
+{
+    memset(arena, 0, sizeof(*arena));
+    if (size == 0)
+        return 0;
+    arena->base = aligned_alloc(ARENA_ALIGN, align_up(size));
+    if (!arena->base)
+        return -1;
+    arena->size = align_up(size);
+    arena->heap_allocs = 1;
+    return 0;
+}
+
+// Frees the overflow blocks newer than stop
+static void free_overflow(Arena *arena, ArenaBlock *stop)
+{
+    while (arena->overflow != stop) {
+        ArenaBlock *block = arena->overflow;
+        arena->overflow = block->next;
+        arena->overflow_used -= block->size;
+        free(block);
+    }
+}
+
+void arena_free(Arena *arena)
+{
+    free_overflow(arena, NULL);
+    free(arena->base);
+    memset(arena, 0, sizeof(*arena));
+}
+
+void arena_reset(Arena *arena, size_t size_hint)
+{
+    free_overflow(arena, NULL);
+    arena->used = 0;
+
+    size_t want = align_up(size_hint > arena->peak ? size_hint : arena->peak);
+    arena->peak = 0;
+    if (want <= arena->size)
+        return;
+    unsigned char *base = aligned_alloc(ARENA_ALIGN, want);
+    if (!base)
+        return;
+    free(arena->base);
+    arena->base = base;
+    arena->size = want;
+    arena->heap_allocs++;
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+    if (!arena)
+        return malloc(size ? size : 1);
+
+    size = align_up(size ? size : 1);
+    if (arena->size - arena->used >= size) {
+        void *p = arena->base + arena->used;
+        arena->used += size;
+        note_peak(arena);
+        return p;
+    }
+
+    // the header takes a whole alignment unit so the data stays aligned
+    ArenaBlock *block = aligned_alloc(ARENA_ALIGN, ARENA_ALIGN + size);
+    if (!block)
+        return NULL;
+    block->next = arena->overflow;
+    block->size = size;
+    arena->overflow = block;
+    arena->overflow_used += size;
+    arena->heap_allocs++;
+    note_peak(arena);
+    return (unsigned char *)block + ARENA_ALIGN;
+}
+
+void *arena_calloc(Arena *arena, size_t n, size_t size)
+{
+    if (!arena)
+        return calloc(n ? n : 1, size ? size : 1);
+    if (size && n > (size_t)-1 / size)
+        return NULL;
+    void *p = arena_alloc(arena, n * size);
+    if (p)
+        memset(p, 0, n * size);
+    return p;
+}
+
+void arena_dealloc(Arena *arena, void *p)
+{
+    if (!arena)
+        free(p);
+}
+
+ArenaMark arena_mark(const Arena *arena)
+{
+    ArenaMark mark = { 0, NULL };
+    if (arena) {
+        mark.used = arena->used;
+        mark.overflow = arena->overflow;
+    }
+    return mark;
+}
+
+void arena_release(Arena *arena, ArenaMark mark)
+{
+    if (!arena)
+        return;
+    free_overflow(arena, mark.overflow);
+    arena->used = mark.used;
+}
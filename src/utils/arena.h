@@ -0,0 +1,57 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator for the scratch buffers of one image: an allocation is a
+// pointer increment in one block, nothing is freed on its own, and the whole
+// block is handed back at once by arena_release / arena_reset. What does not
+// fit in the block gets its own heap allocation, freed with the rest; the next
+// arena_reset enlarges the block to the most the arena ever held, so once an
+// image of each size has gone through, solving another one costs no malloc.
+//
+// Every function accepts a NULL arena, meaning plain heap memory:
+// arena_alloc is malloc and arena_dealloc is free. Code written against an
+// Arena * then works with or without one.
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    unsigned char *base;    // the block
+    size_t size;
+    size_t used;
+    ArenaBlock *overflow;   // allocations that did not fit, newest first
+    size_t overflow_used;
+    size_t peak;            // most bytes held at once since the last reset
+    long heap_allocs;       // malloc calls made on behalf of the arena, in all
+} Arena;
+
+// State to come back to with arena_release
+typedef struct {
+    size_t used;
+    ArenaBlock *overflow;
+} ArenaMark;
+
+// Block of size bytes (0: allocated by the first arena_reset). Returns 0, or -1
+// if out of memory.
+int arena_init(Arena *arena, size_t size);
+void arena_free(Arena *arena);
+
+// Drops every allocation and makes the block at least size_hint bytes, and at
+// least the peak since the previous reset (it never shrinks). If the block
+// cannot grow, the old one is kept.
+void arena_reset(Arena *arena, size_t size_hint);
+
+// size bytes aligned on 64 (a cache line), uninitialized; NULL if out of memory
+void *arena_alloc(Arena *arena, size_t size);
+// n * size bytes set to 0
+void *arena_calloc(Arena *arena, size_t n, size_t size);
+// free() for a NULL arena, nothing otherwise (the memory comes back with the block)
+void arena_dealloc(Arena *arena, void *p);
+
+// Scratch scope: everything allocated after arena_mark is dropped by
+// arena_release, in LIFO order
+ArenaMark arena_mark(const Arena *arena);
+void arena_release(Arena *arena, ArenaMark mark);
+
+#endif
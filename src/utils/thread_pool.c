@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+struct ThreadPool {
+    pthread_t *threads;
+    int n_workers;              // threads created (size - 1)
+
+    pthread_mutex_t run_lock;   // one job at a time
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;
+    pthread_cond_t done_cv;
+
+    // Current job, protected by lock
+    ThreadPoolTask fn;
+    void *arg;
+    int n_tasks;
+    int next_task;
+    int finished;
+    int stop;
+
+    double worker_cpu_ms;       // protected by lock
+};
+
+int thread_pool_default_size(void)
+{
+    const char *env = getenv("OCR_THREADS");
+    if (env && atoi(env) > 0)
+        return atoi(env);
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+}
+
+static double thread_cpu_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Claims and runs tasks of the current job until none are left; a worker
+// (not the calling thread) adds the CPU time of its tasks to worker_cpu_ms.
+// Called and returns with pool->lock held.
+static void run_tasks(ThreadPool *pool, int worker)
+{
+    while (pool->next_task < pool->n_tasks) {
+        int task = pool->next_task++;
+        ThreadPoolTask fn = pool->fn;
+        void *arg = pool->arg;
+
+        pthread_mutex_unlock(&pool->lock);
+        double cpu = worker ? thread_cpu_ms() : 0;
+        fn(arg, task);
+        if (worker)
+            cpu = thread_cpu_ms() - cpu;
+        pthread_mutex_lock(&pool->lock);
+
+        pool->worker_cpu_ms += cpu;
+
+        if (++pool->finished == pool->n_tasks)
+            pthread_cond_broadcast(&pool->done_cv);
+    }
+}
+
+static void *worker_main(void *data)
+{
+    ThreadPool *pool = data;
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop) {
+        if (pool->next_task < pool->n_tasks)
+            run_tasks(pool, 1);
+        else
+            pthread_cond_wait(&pool->work_cv, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+ThreadPool *thread_pool_create(int n_threads)
+{
+    if (n_threads <= 0)
+        n_threads = thread_pool_default_size();
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    pool->threads = calloc(n_threads, sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cv, NULL);
+    pthread_cond_init(&pool->done_cv, NULL);
+
+    for (int i = 0; i < n_threads - 1; i++) {
+        if (pthread_create(&pool->threads[i], NULL, worker_main, pool) != 0) {
+            fprintf(stderr, "[POOL] ⚠️  Could only start %d worker threads\n", i);
+            break;
+        }
+        pool->n_workers++;
+    }
+
+    return pool;
+}
+
+void thread_pool_destroy(ThreadPool *pool)
+{
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->n_workers; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->done_cv);
+    pthread_cond_destroy(&pool->work_cv);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run_lock);
+    free(pool->threads);
+    free(pool);
+}
+
+int thread_pool_size(const ThreadPool *pool)
+{
+    return pool ? pool->n_workers + 1 : 1;
+}
+
+void thread_pool_run(ThreadPool *pool, int n_tasks, ThreadPoolTask fn, void *arg)
+{
+    if (n_tasks <= 0) return;
+
+    if (!pool || pool->n_workers == 0) {
+        for (int task = 0; task < n_tasks; task++)
+            fn(arg, task);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->run_lock);
+    pthread_mutex_lock(&pool->lock);
+
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->n_tasks = n_tasks;
+    pool->next_task = 0;
+    pool->finished = 0;
+    pthread_cond_broadcast(&pool->work_cv);
+
+    run_tasks(pool, 0);
+    while (pool->finished < pool->n_tasks)
+        pthread_cond_wait(&pool->done_cv, &pool->lock);
+
+    // Leave no claimable work behind for idle workers
+    pool->n_tasks = 0;
+    pool->next_task = 0;
+
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+double thread_pool_worker_cpu_ms(ThreadPool *pool)
+{
+    if (!pool) return 0;
+
+    pthread_mutex_lock(&pool->lock);
+    double ms = pool->worker_cpu_ms;
+    pthread_mutex_unlock(&pool->lock);
+    return ms;
+}
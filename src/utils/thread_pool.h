@@ -0,0 +1,33 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+// Fixed set of worker threads that run "parallel for" jobs: a job is a function
+// called once for every task index in [0, n_tasks). The calling thread works on
+// the job too, and thread_pool_run returns only when every task has finished.
+// Tasks should write to disjoint outputs indexed by their task number, so the
+// result does not depend on which worker ran which task.
+
+typedef struct ThreadPool ThreadPool;
+
+typedef void (*ThreadPoolTask)(void *arg, int task);
+
+// Worker count used when thread_pool_create gets n_threads <= 0:
+// $OCR_THREADS if set, otherwise the number of online cores
+int thread_pool_default_size(void);
+
+// n_threads counts the calling thread, so 1 means "no extra threads"
+ThreadPool *thread_pool_create(int n_threads);
+void thread_pool_destroy(ThreadPool *pool);
+
+int thread_pool_size(const ThreadPool *pool);
+
+// Runs fn(arg, 0..n_tasks-1) across the pool and waits for completion.
+// A NULL pool runs the tasks in order on the calling thread.
+void thread_pool_run(ThreadPool *pool, int n_tasks, ThreadPoolTask fn, void *arg);
+
+// CPU time (ms) the worker threads have spent in tasks since the pool was
+// created; the calling thread's share of a job is not included, its own
+// thread CPU clock already holds it. 0 for a NULL pool.
+double thread_pool_worker_cpu_ms(ThreadPool *pool);
+
+#endif